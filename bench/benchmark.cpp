@@ -0,0 +1,130 @@
+/*
+ * Benchmark of the tracking pipeline. Replays a pair of recorded videos as fast
+ * as possible, without windows, plots and network output, and reports the frame
+ * rate, the time of every stage and the peak memory use.
+ *
+ * Usage: benchmark <config> [-v1 video1] [-v2 video2] [-n frames] [-w warm-up frames]
+ *
+ * The configuration is the one of the tracker, the videos override video1 and
+ * video2. The first frames are not measured (30 by default), while MOG2 learns the
+ * background and the filters settle. Built from this file and the sources in src,
+ * without src/main.cpp.
+ */
+
+#include "config_parser.h"
+#include "profiler.h"
+#include "stereo_tracker.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// peak resident set size of the process in megabytes, -1 if unknown
+static double peak_memory() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+        return usage.ru_maxrss / 1024.0; // kilobytes
+#endif
+    }
+#endif
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <config> [-v1 video1] [-v2 video2] [-n frames] [-w warm-up frames]" << std::endl;
+        return -1;
+    }
+    
+    ConfigParser config;
+    config.parse(argv[1]);
+    
+    int maxFrames = -1;
+    int warmup = 30;
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            std::cerr << "Option " << argv[i] << " needs a value." << std::endl;
+            return -1;
+        }
+        if (strcmp(argv[i], "-v1") == 0) {
+            config.set("video1", argv[i+1]);
+        } else if (strcmp(argv[i], "-v2") == 0) {
+            config.set("video2", argv[i+1]);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            maxFrames = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-w") == 0) {
+            warmup = atoi(argv[i+1]);
+        } else {
+            std::cerr << "Unknown option " << argv[i] << "." << std::endl;
+            return -1;
+        }
+    }
+    
+    config.set("headless", "1");
+    config.set("profile", "1");
+    init_profiler(config);
+    
+    double memoryBefore = peak_memory();
+    
+    StereoTracker tracker;
+    if (!tracker.init(config)) {
+        return -1;
+    }
+    
+    int t = 0;
+    for (int i = 0; i < warmup && t == 0; i++) {
+        t = tracker.next_frame();
+    }
+    if (t != 0) {
+        std::cerr << "The videos end during the warm-up." << std::endl;
+        return -1;
+    }
+    profile_reset();
+    
+    int frames = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (maxFrames < 0 || frames < maxFrames) {
+        ScopedTimer frameTimer(STAGE_FRAME, frames);
+        t = tracker.next_frame();
+        if (t != 0) {
+            // the end of the videos isn't a frame
+            frameTimer.discard();
+            break;
+        }
+        frames++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (t == -1) {
+        std::cerr << "Cannot read the videos after " << frames << " frames." << std::endl;
+    }
+    
+    VideoTracker *tracker1 = tracker.getTracker(0);
+    printf("balloons       %d\n", tracker.getBalloonCount());
+    printf("frame size     %d x %d, scaled to %.0f x %.0f\n", tracker1->getFrameWidth(), tracker1->getFrameHeight(),
+            tracker1->getScaledWidth(), tracker1->getScaledHeight());
+    printf("frames         %d (after %d warm-up frames)\n", frames, warmup);
+    printf("time           %.3f s\n", seconds);
+    if (frames > 0) {
+        printf("frame rate     %.2f fps, %.3f ms per frame\n", frames / seconds, 1000 * seconds / frames);
+    }
+    if (peak_memory() >= 0) {
+        printf("peak memory    %.1f MB (%.1f MB before the trackers were created)\n", peak_memory(), memoryBefore);
+    }
+    printf("\n");
+    profile_report();
+    
+    write_trace();
+    
+    return t == -1 ? -1 : 0;
+}
@@ -0,0 +1,411 @@
+/*
+ * Accuracy against speed of the tracking pipeline on a sequence with ground truth,
+ * usually one made by the synthesize tool. Runs the tracker for every combination
+ * of the swept parameters and prints for each run
+ *   fps        frames per second of the tracking, without the warm-up frames
+ *   rms        RMS distance between the tracked and the true positions, and its
+ *              components along the axes, in the coordinates of the first camera
+ *              and the units of the calibration
+ *   switches   identity switches, counted whenever the true balloon matched to a
+ *              track changes
+ *   lost       time in seconds, summed over the balloons, in which a balloon in view
+ *              of both cameras isn't matched to any track
+ * Runs that no other run beats in all four are marked as Pareto optimal, the rms
+ * of a run in which no balloon was ever matched is -1.
+ *
+ * Usage: evaluate <config> <ground truth> [-p key=value,value,...]... [-n frames]
+ *                 [-w warm-up frames] [-t loss threshold] [-s seed] [-o results.csv]
+ *
+ * Every -p adds a swept configuration key, e.g. -p nParticles=100,200,400. In every
+ * frame the image states of the tracks are triangulated with the projection matrices
+ * of the calibration and matched to the true balloons in view by the assignment with
+ * the least total distance. A pair further apart than the loss threshold (one
+ * baseline by default) isn't a match. The filters are seeded the same way (1 by
+ * default) before every run and move by the frame rate of the videos, so the runs
+ * are repeatable. Built from this file and the sources in src, without src/main.cpp.
+ */
+
+#include "assignment.h"
+#include "condensation.h"
+#include "config_parser.h"
+#include "stereo_tracker.h"
+
+#include "opencv2/calib3d/calib3d.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * True position of a balloon in the coordinates of the first camera, and in the
+ * rectified frames at the full resolution.
+ */
+struct TruePosition {
+    double x, y, z;
+    double u1, v1, u2, v2;
+};
+
+/**
+ * Swept configuration key and its values.
+ */
+struct Sweep {
+    std::string key;
+    std::vector<std::string> values;
+};
+
+/**
+ * Results of one run of the tracker.
+ */
+struct RunResult {
+    std::string parameters;
+    int frames;
+    double fps;
+    double rms;
+    cv::Point3d axisRms;
+    int switches;
+    double lost;
+};
+
+/**
+ * Rectified projection matrices of both cameras and the rotation of the first
+ * camera into its rectified frame.
+ */
+struct Calibration {
+    cv::Mat P1, P2, R1;
+};
+
+// reads the ground truth written by the synthesize tool, indexed by frame and balloon
+static bool read_ground_truth(const char *file, std::vector<std::vector<TruePosition> > &truth) {
+    FILE *f = fopen(file, "r");
+    if (f == NULL) {
+        return false;
+    }
+    char line[512];
+    if (fgets(line, sizeof(line), f) == NULL) { // header
+        fclose(f);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        int frame, balloon;
+        TruePosition p;
+        if (sscanf(line, "%d,%d,%lf,%lf,%lf,%lf,%lf,%lf,%lf", &frame, &balloon, &p.x, &p.y, &p.z,
+                &p.u1, &p.v1, &p.u2, &p.v2) != 9 || frame < 0 || balloon < 0) {
+            continue;
+        }
+        if (frame >= truth.size()) {
+            truth.resize(frame + 1);
+        }
+        if (balloon >= truth[frame].size()) {
+            truth[frame].resize(balloon + 1);
+        }
+        truth[frame][balloon] = p;
+    }
+    fclose(f);
+    return true;
+}
+
+static bool read_calibration(ConfigParser &config, Calibration &calibration) {
+    const char* calibFile = config.getString("calibrationFile");
+    cv::FileStorage fs(calibFile == NULL ? "" : calibFile, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        return false;
+    }
+    fs["P1"] >> calibration.P1;
+    fs["P2"] >> calibration.P2;
+    fs["R1"] >> calibration.R1;
+    if (calibration.P1.empty() || calibration.P2.empty() || calibration.R1.empty()) {
+        return false;
+    }
+    calibration.P1.convertTo(calibration.P1, CV_64F);
+    calibration.P2.convertTo(calibration.P2, CV_64F);
+    calibration.R1.convertTo(calibration.R1, CV_64F);
+    return true;
+}
+
+static bool parse_sweep(const char *arg, Sweep &sweep) {
+    std::string s(arg);
+    std::size_t eq = s.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        return false;
+    }
+    sweep.key = s.substr(0, eq);
+    std::stringstream ss(s.substr(eq + 1));
+    std::string value;
+    while (getline(ss, value, ',')) {
+        if (!value.empty()) {
+            sweep.values.push_back(value);
+        }
+    }
+    return !sweep.values.empty();
+}
+
+// positions of all tracks in the coordinates of the first camera, triangulated from their image states
+static void triangulate_tracks(StereoTracker &tracker, const Calibration &calibration, double scale,
+        std::vector<cv::Point3d> &positions) {
+    int n = tracker.getBalloonCount();
+    cv::Mat points1(2, n, CV_64F), points2(2, n, CV_64F);
+    for (int i = 0; i < n; i++) {
+        points1.at<double>(0, i) = tracker.getTracker(0)->getStateX(i) / scale;
+        points1.at<double>(1, i) = tracker.getTracker(0)->getStateY(i) / scale;
+        points2.at<double>(0, i) = tracker.getTracker(1)->getStateX(i) / scale;
+        points2.at<double>(1, i) = tracker.getTracker(1)->getStateY(i) / scale;
+    }
+    cv::Mat homogeneous;
+    triangulatePoints(calibration.P1, calibration.P2, points1, points2, homogeneous);
+    
+    positions.resize(n);
+    for (int i = 0; i < n; i++) {
+        double w = homogeneous.at<double>(3, i);
+        cv::Mat rectified = (cv::Mat_<double>(3, 1) << homogeneous.at<double>(0, i) / w,
+                homogeneous.at<double>(1, i) / w, homogeneous.at<double>(2, i) / w);
+        // the projection matrices work in the rectified frame of the first camera
+        cv::Mat camera = calibration.R1.t() * rectified;
+        positions[i] = cv::Point3d(camera.at<double>(0), camera.at<double>(1), camera.at<double>(2));
+    }
+}
+
+// tracks the sequence once with the given configuration
+static bool run(ConfigParser config, const std::vector<std::vector<TruePosition> > &truth,
+        const Calibration &calibration, int maxFrames, int warmup, double lossThreshold, unsigned seed,
+        RunResult &result) {
+    Condensation::seed(seed);
+    StereoTracker tracker;
+    if (!tracker.init(config)) {
+        return false;
+    }
+    int n = tracker.getBalloonCount();
+    VideoTracker *tracker1 = tracker.getTracker(0);
+    double scale = tracker1->getScaledWidth() / tracker1->getFrameWidth();
+    double width = tracker1->getFrameWidth();
+    double height = tracker1->getFrameHeight();
+    double fps = tracker1->getFps() > 0 ? tracker1->getFps() : 30;
+
+    cv::Point3d squaredError(0, 0, 0);
+    int matched = 0;
+    int lostFrames = 0;
+    int switches = 0;
+    std::vector<int> identities(n, -1); // true balloon last matched to each track
+    std::vector<cv::Point3d> positions;
+    std::vector<int> visible;
+    std::vector<double> costs;
+    std::vector<int> assignment(n);
+    AssignmentSolver solver;
+
+    double seconds = 0;
+    int frame = 0;
+    int frames = 0;
+    while (frame < truth.size() && (maxFrames < 0 || frames < maxFrames)) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int t = tracker.next_frame();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        if (t != 0) {
+            break;
+        }
+        if (frame++ < warmup) {
+            continue;
+        }
+        seconds += std::chrono::duration<double>(end - start).count();
+        frames++;
+
+        const std::vector<TruePosition> &balloons = truth[frame - 1];
+        visible.clear();
+        for (int j = 0; j < balloons.size(); j++) {
+            const TruePosition &p = balloons[j];
+            if (p.u1 >= 0 && p.u1 < width && p.v1 >= 0 && p.v1 < height
+                    && p.u2 >= 0 && p.u2 < width && p.v2 >= 0 && p.v2 < height) {
+                visible.push_back(j);
+            }
+        }
+        triangulate_tracks(tracker, calibration, scale, positions);
+
+        // tracks are matched to the visible balloons, or to one of the extra columns
+        // that leave them unmatched; pairs beyond the threshold cost more than those
+        int m = visible.size();
+        int cols = m + n;
+        costs.assign(n * cols, lossThreshold);
+        for (int i = 0; i < n; i++) {
+            for (int k = 0; k < m; k++) {
+                const TruePosition &p = balloons[visible[k]];
+                cv::Point3d d = positions[i] - cv::Point3d(p.x, p.y, p.z);
+                double distance = std::sqrt(d.dot(d));
+                costs[i*cols + k] = distance <= lossThreshold ? distance : 2 * lossThreshold;
+            }
+        }
+        solver.solve(&costs[0], n, cols, &assignment[0]);
+
+        int found = 0;
+        for (int i = 0; i < n; i++) {
+            int k = assignment[i];
+            if (k >= m || costs[i*cols + k] > lossThreshold) {
+                continue;
+            }
+            int j = visible[k];
+            if (identities[i] >= 0 && identities[i] != j) {
+                switches++;
+            }
+            identities[i] = j;
+
+            const TruePosition &p = balloons[j];
+            cv::Point3d d = positions[i] - cv::Point3d(p.x, p.y, p.z);
+            squaredError += cv::Point3d(d.x*d.x, d.y*d.y, d.z*d.z);
+            matched++;
+            found++;
+        }
+        lostFrames += m - found;
+    }
+
+    result.frames = frames;
+    result.fps = seconds > 0 ? frames / seconds : 0;
+    if (matched > 0) {
+        result.axisRms = cv::Point3d(std::sqrt(squaredError.x / matched), std::sqrt(squaredError.y / matched),
+                std::sqrt(squaredError.z / matched));
+        result.rms = std::sqrt((squaredError.x + squaredError.y + squaredError.z) / matched);
+    } else {
+        result.axisRms = cv::Point3d(-1, -1, -1);
+        result.rms = -1;
+    }
+    result.switches = switches;
+    result.lost = lostFrames / fps;
+    return frames > 0;
+}
+
+// a run is dominated if another one is at least as good in everything and better in something
+static bool dominated(const RunResult &r, const std::vector<RunResult> &results) {
+    for (int i = 0; i < results.size(); i++) {
+        const RunResult &o = results[i];
+        if (o.rms < 0 || r.rms < 0) {
+            continue;
+        }
+        bool noWorse = o.fps >= r.fps && o.rms <= r.rms && o.switches <= r.switches && o.lost <= r.lost;
+        bool better = o.fps > r.fps || o.rms < r.rms || o.switches < r.switches || o.lost < r.lost;
+        if (noWorse && better) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <config> <ground truth> [-p key=value,value,...]... [-n frames]"
+                " [-w warm-up frames] [-t loss threshold] [-s seed] [-o results.csv]" << std::endl;
+        return -1;
+    }
+
+    ConfigParser config;
+    config.parse(argv[1]);
+    config.set("headless", "1");
+
+    std::vector<std::vector<TruePosition> > truth;
+    if (!read_ground_truth(argv[2], truth)) {
+        std::cerr << "Cannot read the ground truth from " << argv[2] << "." << std::endl;
+        return -1;
+    }
+
+    Calibration calibration;
+    if (!read_calibration(config, calibration)) {
+        std::cerr << "The calibration file needs P1, P2 and R1." << std::endl;
+        return -1;
+    }
+
+    std::vector<Sweep> sweeps;
+    int maxFrames = -1;
+    int warmup = 30;
+    // the baseline is the translation of the second rectified camera, -P2(0, 3) / P2(0, 0)
+    double lossThreshold = std::abs(calibration.P2.at<double>(0, 3) / calibration.P2.at<double>(0, 0));
+    unsigned seed = 1;
+    const char *output = NULL;
+    for (int i = 3; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            std::cerr << "Option " << argv[i] << " needs a value." << std::endl;
+            return -1;
+        }
+        if (strcmp(argv[i], "-p") == 0) {
+            Sweep sweep;
+            if (!parse_sweep(argv[i+1], sweep)) {
+                std::cerr << "Sweeps need to be in the key=value,value format." << std::endl;
+                return -1;
+            }
+            sweeps.push_back(sweep);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            maxFrames = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-w") == 0) {
+            warmup = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            lossThreshold = atof(argv[i+1]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            seed = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-o") == 0) {
+            output = argv[i+1];
+        } else {
+            std::cerr << "Unknown option " << argv[i] << "." << std::endl;
+            return -1;
+        }
+    }
+
+    // every combination of the swept values, the last key changes fastest
+    std::vector<RunResult> results;
+    std::vector<int> index(sweeps.size(), 0);
+    while (true) {
+        ConfigParser runConfig = config;
+        std::string parameters;
+        for (int s = 0; s < sweeps.size(); s++) {
+            runConfig.set(sweeps[s].key, sweeps[s].values[index[s]]);
+            parameters += (s > 0 ? " " : "") + sweeps[s].key + "=" + sweeps[s].values[index[s]];
+        }
+        if (parameters.empty()) {
+            parameters = "(configuration)";
+        }
+
+        RunResult result;
+        result.parameters = parameters;
+        std::cout << "Running " << parameters << "..." << std::endl;
+        if (run(runConfig, truth, calibration, maxFrames, warmup, lossThreshold, seed, result)) {
+            results.push_back(result);
+        } else {
+            std::cerr << "The run with " << parameters << " failed." << std::endl;
+        }
+
+        int s = sweeps.size() - 1;
+        while (s >= 0 && ++index[s] == sweeps[s].values.size()) {
+            index[s--] = 0;
+        }
+        if (s < 0) {
+            break;
+        }
+    }
+
+    FILE *csv = NULL;
+    if (output != NULL) {
+        csv = fopen(output, "w");
+        if (csv == NULL) {
+            std::cerr << "Cannot write " << output << "." << std::endl;
+        } else {
+            fprintf(csv, "parameters,frames,fps,rms,rms_x,rms_y,rms_z,switches,lost,pareto\n");
+        }
+    }
+
+    printf("\n%-40s %7s %9s %10s %10s %10s %10s %9s %9s %7s\n", "parameters", "frames", "fps", "rms", "rms x",
+            "rms y", "rms z", "switches", "lost [s]", "pareto");
+    for (int i = 0; i < results.size(); i++) {
+        const RunResult &r = results[i];
+        bool pareto = r.rms >= 0 && !dominated(r, results);
+        printf("%-40s %7d %9.2f %10.4f %10.4f %10.4f %10.4f %9d %9.2f %7s\n", r.parameters.c_str(), r.frames, r.fps,
+                r.rms, r.axisRms.x, r.axisRms.y, r.axisRms.z, r.switches, r.lost, pareto ? "*" : "");
+        if (csv != NULL) {
+            fprintf(csv, "\"%s\",%d,%.3f,%.6f,%.6f,%.6f,%.6f,%d,%.3f,%d\n", r.parameters.c_str(), r.frames, r.fps,
+                    r.rms, r.axisRms.x, r.axisRms.y, r.axisRms.z, r.switches, r.lost, pareto ? 1 : 0);
+        }
+    }
+    if (csv != NULL) {
+        fclose(csv);
+    }
+
+    return results.empty() ? -1 : 0;
+}
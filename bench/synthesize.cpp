@@ -0,0 +1,460 @@
+/*
+ * Generator of synthetic stereo sequences for the benchmark. Balloons of distinct
+ * colours move in front of a textured background under the motion model of the
+ * Condensation filter, extended to three dimensions, and are projected into both
+ * cameras through a stereo calibration written by the calibration mode.
+ *
+ * Usage: synthesize <config> <output directory> [-b balloons] [-n frames] [-f fps]
+ *                   [-r resolution factor] [-s seed]
+ *
+ * The configuration is the one of the tracker. The calibration is read from its
+ * calibrationFile, the image size is twice the principal point of the first camera
+ * times the resolution factor. The output directory gets
+ *   camera1.avi, camera2.avi  the raw (distorted, unrectified) videos
+ *   balloonN.png              the balloon images for balloonImageFileN
+ *   calibration.yml           the calibration, scaled to the generated resolution
+ *   ground_truth.csv          frame, balloon, x, y, z, u1, v1, u2, v2
+ *   synthetic.cfg             the configuration with the keys above replaced
+ * The ground truth position x, y, z is in the coordinate system of the first camera
+ * and in the units of the calibration, u and v are the coordinates of the balloon
+ * centre in the rectified images of both cameras at the generated resolution.
+ *
+ * The motion can be tuned with the keys below, lengths are in the calibration units
+ * and default to fractions of the width of the volume the balloons move in:
+ *   synthDepthMin, synthDepthMax   depth range of the volume (4 and 12 baselines)
+ *   synthBalloonRadius             (0.04 widths)
+ *   synthGravity                   (0.05 widths/s^2)
+ *   synthSigmaVelocity             (0.2 widths/s)
+ *   synthSigmaAcceleration         (0.3 widths/s^2)
+ *   synthMaxAcceleration           (0.6 widths/s^2)
+ *   synthNoise                     standard deviation of the sensor noise (2)
+ * while airResistance, accelerationReduction and processRandomHit are shared with
+ * the filter. Built from this file, src/config_parser.cpp and src/util.cpp.
+ */
+
+#include "config_parser.h"
+#include "util.h"
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/calib3d/calib3d.hpp"
+#include "opencv2/highgui/highgui.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * State of a simulated balloon, the same as a Condensation particle but in 3D.
+ */
+struct SyntheticBalloon {
+    cv::Point3d position;
+    cv::Point3d velocity;
+    cv::Point3d acceleration;
+    cv::Scalar color;
+};
+
+/**
+ * Box in the coordinates of the first camera in which the balloons move.
+ */
+struct Volume {
+    cv::Point3d center;
+    cv::Point3d half; // half of the size along every axis
+};
+
+static double airResistance;
+static double accReduction;
+static double randomHit;
+static double gravity;
+static double sigmaVelocity;
+static double sigmaAcceleration;
+static double maxAcceleration;
+
+static std::mt19937 generator;
+
+static int sgn(double d) {
+    return d < 0 ? -1 : 1;
+}
+
+// one axis of Condensation::applyDynamics, the acceleration towards the centre
+// gets likelier the further the balloon is from it
+static void move_axis(double &p, double &v, double &a, double center, double half, double g, double dt) {
+    std::normal_distribution<double> normalAcc(0, sigmaAcceleration);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    p += v * dt;
+    v *= pow(1 - airResistance, dt);
+    v += a * dt + g * dt;
+    a *= pow(accReduction, dt);
+
+    double prob = std::abs(center - p) / half;
+    if (uniform(generator) < prob*prob*prob) {
+        a += std::abs(normalAcc(generator)) * sgn(center - p);
+    }
+    if (std::abs(a) > maxAcceleration) {
+        a = sgn(a) * maxAcceleration;
+    }
+
+    // the model doesn't bound the position, walls at a quarter beyond the volume
+    // keep the balloons from leaving the view for good
+    double wall = 1.25 * half;
+    if (std::abs(p - center) > wall) {
+        p = center + sgn(p - center) * wall;
+        v = -v;
+    }
+}
+
+static void move_balloon(SyntheticBalloon &b, const Volume &volume, double dt) {
+    std::normal_distribution<double> normalVel(0, sigmaVelocity);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    // y points down in the camera coordinates, just like in the image
+    move_axis(b.position.x, b.velocity.x, b.acceleration.x, volume.center.x, volume.half.x, 0, dt);
+    move_axis(b.position.y, b.velocity.y, b.acceleration.y, volume.center.y, volume.half.y, gravity, dt);
+    move_axis(b.position.z, b.velocity.z, b.acceleration.z, volume.center.z, volume.half.z, 0, dt);
+
+    if (uniform(generator) < randomHit) {
+        b.acceleration = cv::Point3d(0, 0, 0);
+        b.velocity = cv::Point3d(normalVel(generator), normalVel(generator), normalVel(generator));
+    }
+}
+
+// evenly spaced fully saturated hues
+static cv::Scalar balloon_color(int i, int n) {
+    cv::Mat hsv(1, 1, CV_8UC3, cv::Scalar(i * 180 / n, 255, 230));
+    cv::Mat bgr;
+    cvtColor(hsv, bgr, CV_HSV2BGR);
+    cv::Vec3b c = bgr.at<cv::Vec3b>(0, 0);
+    return cv::Scalar(c[0], c[1], c[2]);
+}
+
+// balloon with a highlight towards the upper left and a darker rim
+static void draw_balloon(cv::Mat &img, cv::Point2d center, double radius, cv::Scalar color) {
+    const int STEPS = 6;
+    for (int s = 0; s < STEPS; s++) {
+        double t = (double)s / STEPS;
+        double r = radius * (1 - 0.7*t);
+        cv::Point2d c = center - cv::Point2d(radius, radius) * (0.25*t);
+        double shade = 0.75 + 0.35*t;
+        cv::Scalar col(std::min(255.0, color[0]*shade), std::min(255.0, color[1]*shade), std::min(255.0, color[2]*shade));
+        // fixed point with 4 fractional bits for sub-pixel positions
+        circle(img, cv::Point(cvRound(c.x*16), cvRound(c.y*16)), std::max(1, cvRound(r*16)), col, -1, CV_AA, 4);
+    }
+}
+
+// smooth gradient with a blurred random texture, so the background model has something to learn
+static cv::Mat make_background(cv::Size size) {
+    cv::Mat background(size, CV_8UC3);
+    for (int y = 0; y < size.height; y++) {
+        double t = (double)y / size.height;
+        background.row(y).setTo(cv::Scalar(170 - 60*t, 150 - 50*t, 120 - 40*t));
+    }
+    cv::Mat texture(size, CV_16SC3);
+    randn(texture, cv::Scalar::all(0), cv::Scalar::all(40));
+    GaussianBlur(texture, texture, cv::Size(0, 0), 6);
+    cv::Mat result;
+    background.convertTo(result, CV_16SC3);
+    result += texture;
+    result.convertTo(background, CV_8UC3);
+    return background;
+}
+
+static void add_noise(cv::Mat &frame, double sigma, cv::Mat &scratch, cv::Mat &noise) {
+    if (sigma <= 0) {
+        return;
+    }
+    frame.convertTo(scratch, CV_16SC3);
+    noise.create(frame.size(), CV_16SC3);
+    randn(noise, cv::Scalar::all(0), cv::Scalar::all(sigma));
+    scratch += noise;
+    scratch.convertTo(frame, CV_8UC3);
+}
+
+// projection of a point given in the coordinates of the first camera by a rectified projection matrix
+static cv::Point2d project_rectified(const cv::Mat &R1, const cv::Mat &P, cv::Point3d x) {
+    cv::Mat xr = R1 * (cv::Mat_<double>(3, 1) << x.x, x.y, x.z);
+    cv::Mat h = P * (cv::Mat_<double>(4, 1) << xr.at<double>(0), xr.at<double>(1), xr.at<double>(2), 1.0);
+    return cv::Point2d(h.at<double>(0) / h.at<double>(2), h.at<double>(1) / h.at<double>(2));
+}
+
+// scales the focal lengths and the principal point of a camera or projection matrix
+static cv::Mat scale_intrinsics(const cv::Mat &m, double factor) {
+    cv::Mat s;
+    m.convertTo(s, CV_64F);
+    s.row(0) *= factor;
+    s.row(1) *= factor;
+    return s;
+}
+
+static std::string join(const std::string &dir, const std::string &file) {
+    if (dir.empty() || dir[dir.size()-1] == '/') {
+        return dir + file;
+    }
+    return dir + "/" + file;
+}
+
+// copies the configuration with the given keys replaced, the parser keeps the first
+// value of a key, so the new values go first and the old lines are commented out
+static bool write_config(const char *input, const std::string &output,
+        const std::vector<std::pair<std::string, std::string> > &values) {
+    std::ifstream in(input);
+    std::ofstream out(output.c_str());
+    if (!out) {
+        return false;
+    }
+
+    std::set<std::string> keys;
+    out << "# synthetic sequence, generated from " << input << std::endl;
+    for (int i = 0; i < values.size(); i++) {
+        out << values[i].first << " = " << values[i].second << std::endl;
+        keys.insert(values[i].first);
+    }
+    out << std::endl;
+
+    std::string line;
+    while (getline(in, line)) {
+        std::size_t eq = line.find('=');
+        std::string key = eq == std::string::npos ? "" : line.substr(0, eq);
+        std::size_t b = key.find_first_not_of(" \t");
+        std::size_t e = key.find_last_not_of(" \t");
+        key = b == std::string::npos ? "" : key.substr(b, e - b + 1);
+        if (!line.empty() && line[line.size()-1] == '\r') {
+            line.erase(line.size()-1);
+        }
+        out << (keys.count(key) ? "# " : "") << line << std::endl;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <config> <output directory> [-b balloons] [-n frames] [-f fps]"
+                " [-r resolution factor] [-s seed]" << std::endl;
+        return -1;
+    }
+
+    ConfigParser config;
+    config.parse(argv[1]);
+    std::string dir = argv[2];
+
+    int nBalloons = 8;
+    int nFrames = 600;
+    double fps = 30;
+    double resolution = 1;
+    unsigned seed = 1;
+    for (int i = 3; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            std::cerr << "Option " << argv[i] << " needs a value." << std::endl;
+            return -1;
+        }
+        if (strcmp(argv[i], "-b") == 0) {
+            nBalloons = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            nFrames = atoi(argv[i+1]);
+        } else if (strcmp(argv[i], "-f") == 0) {
+            fps = atof(argv[i+1]);
+        } else if (strcmp(argv[i], "-r") == 0) {
+            resolution = atof(argv[i+1]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            seed = atoi(argv[i+1]);
+        } else {
+            std::cerr << "Unknown option " << argv[i] << "." << std::endl;
+            return -1;
+        }
+    }
+    if (nBalloons < 1 || nFrames < 1 || fps <= 0 || resolution <= 0) {
+        std::cerr << "Invalid options." << std::endl;
+        return -1;
+    }
+    generator.seed(seed);
+    cv::theRNG().state = seed;
+
+    // calibration of the stereo pair, scaled to the generated resolution
+    const char* calibFile = config.getString("calibrationFile");
+    cv::FileStorage fs(calibFile == NULL ? "" : calibFile, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        std::cerr << "Cannot open the calibration file." << std::endl;
+        return -1;
+    }
+    cv::Mat CM[2], D[2], R, T, R1[2], P[2];
+    for (int c = 0; c < 2; c++) {
+        fs[concat("CM", c+1)] >> CM[c];
+        fs[concat("D", c+1)] >> D[c];
+        fs[concat("R", c+1)] >> R1[c];
+        fs[concat("P", c+1)] >> P[c];
+    }
+    fs["R"] >> R;
+    fs["T"] >> T;
+    bool complete = !R.empty() && !T.empty();
+    for (int c = 0; c < 2; c++) {
+        complete = complete && !CM[c].empty() && !D[c].empty() && !R1[c].empty() && !P[c].empty();
+    }
+    if (!complete) {
+        std::cerr << "The calibration file needs CM1, CM2, D1, D2, R, T, R1, R2, P1 and P2." << std::endl;
+        return -1;
+    }
+    for (int c = 0; c < 2; c++) {
+        CM[c] = scale_intrinsics(CM[c], resolution);
+        P[c] = scale_intrinsics(P[c], resolution);
+        R1[c].convertTo(R1[c], CV_64F);
+        D[c].convertTo(D[c], CV_64F);
+    }
+    R.convertTo(R, CV_64F);
+    T.convertTo(T, CV_64F);
+    cv::Size size(cvRound(2 * CM[0].at<double>(0, 2)), cvRound(2 * CM[0].at<double>(1, 2)));
+
+    cv::Mat rvec[2], tvec[2];
+    rvec[0] = cv::Mat::zeros(3, 1, CV_64F);
+    tvec[0] = cv::Mat::zeros(3, 1, CV_64F);
+    Rodrigues(R, rvec[1]);
+    tvec[1] = T;
+
+    // the volume lies between the cameras, as wide and high as the first camera sees at its near end
+    double baseline = cv::norm(T);
+    double zMin = config.getDouble("synthDepthMin", 4 * baseline);
+    double zMax = config.getDouble("synthDepthMax", 12 * baseline);
+    cv::Mat c2 = -R.t() * T; // centre of the second camera
+    Volume volume;
+    volume.center = cv::Point3d(c2.at<double>(0) / 2, 0, (zMin + zMax) / 2);
+    volume.half = cv::Point3d(0.4 * size.width / CM[0].at<double>(0, 0) * zMin,
+            0.4 * size.height / CM[0].at<double>(1, 1) * zMin, (zMax - zMin) / 2);
+    double width = 2 * volume.half.x;
+
+    double balloonRadius = config.getDouble("synthBalloonRadius", 0.04 * width);
+    airResistance = config.getDouble("airResistance", 0.5);
+    accReduction = config.getDouble("accelerationReduction", 0.5);
+    randomHit = config.getDouble("processRandomHit", 0.01);
+    gravity = config.getDouble("synthGravity", 0.05 * width);
+    sigmaVelocity = config.getDouble("synthSigmaVelocity", 0.2 * width);
+    sigmaAcceleration = config.getDouble("synthSigmaAcceleration", 0.3 * width);
+    maxAcceleration = config.getDouble("synthMaxAcceleration", 0.6 * width);
+    double noise = config.getDouble("synthNoise", 2);
+
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::normal_distribution<double> normalVel(0, sigmaVelocity);
+    std::vector<SyntheticBalloon> balloons(nBalloons);
+    std::vector<std::pair<std::string, std::string> > values;
+    for (int i = 0; i < nBalloons; i++) {
+        SyntheticBalloon &b = balloons[i];
+        b.position = volume.center + cv::Point3d(uniform(generator) * volume.half.x,
+                uniform(generator) * volume.half.y, uniform(generator) * volume.half.z);
+        b.velocity = cv::Point3d(normalVel(generator), normalVel(generator), normalVel(generator));
+        b.acceleration = cv::Point3d(0, 0, 0);
+        b.color = balloon_color(i, nBalloons);
+
+        // the filter takes the mean colour of the non-black pixels of the balloon image
+        int r = 20;
+        cv::Mat image = cv::Mat::zeros(2*r + 1, 2*r + 1, CV_8UC3);
+        draw_balloon(image, cv::Point2d(r, r), r, b.color);
+        std::string file = join(dir, concat("balloon", i+1) + std::string(".png"));
+        if (!cv::imwrite(file, image)) {
+            std::cerr << "Cannot write " << file << "." << std::endl;
+            return -1;
+        }
+        values.push_back(std::make_pair(std::string(concat("balloonImageFile", i+1)), file));
+        values.push_back(std::make_pair(std::string(concat("showBalloonPlot", i+1)), std::string("0")));
+    }
+
+    std::string calibOut = join(dir, "calibration.yml");
+    cv::FileStorage out(calibOut, cv::FileStorage::WRITE);
+    for (int c = 0; c < 2; c++) {
+        out << concat("CM", c+1) << CM[c];
+        out << concat("D", c+1) << D[c];
+    }
+    out << "R" << R << "T" << T;
+    for (int c = 0; c < 2; c++) {
+        out << concat("R", c+1) << R1[c];
+        out << concat("P", c+1) << P[c];
+    }
+    out.release();
+
+    cv::VideoWriter writers[2];
+    std::string videos[2];
+    cv::Mat backgrounds[2];
+    for (int c = 0; c < 2; c++) {
+        videos[c] = join(dir, concat("camera", c+1) + std::string(".avi"));
+        if (!writers[c].open(videos[c], CV_FOURCC('M', 'J', 'P', 'G'), fps, size)) {
+            std::cerr << "Cannot write " << videos[c] << "." << std::endl;
+            return -1;
+        }
+        backgrounds[c] = make_background(size);
+    }
+
+    values.push_back(std::make_pair(std::string("video1"), videos[0]));
+    values.push_back(std::make_pair(std::string("video2"), videos[1]));
+    values.push_back(std::make_pair(std::string("nBalloons"), std::to_string(nBalloons)));
+    values.push_back(std::make_pair(std::string("calibrationFile"), calibOut));
+    std::string configOut = join(dir, "synthetic.cfg");
+    if (!write_config(argv[1], configOut, values)) {
+        std::cerr << "Cannot write " << configOut << "." << std::endl;
+        return -1;
+    }
+
+    std::string truthFile = join(dir, "ground_truth.csv");
+    FILE *truth = fopen(truthFile.c_str(), "w");
+    if (truth == NULL) {
+        std::cerr << "Cannot write " << truthFile << "." << std::endl;
+        return -1;
+    }
+    fprintf(truth, "frame,balloon,x,y,z,u1,v1,u2,v2\n");
+
+    double dt = 1 / fps;
+    cv::Mat frame, scratch, noiseImg;
+    std::vector<cv::Point3d> points(nBalloons);
+    std::vector<cv::Point2d> projected;
+    std::vector<int> order(nBalloons);
+    std::vector<double> depth(nBalloons);
+    for (int f = 0; f < nFrames; f++) {
+        for (int i = 0; i < nBalloons; i++) {
+            points[i] = balloons[i].position;
+            cv::Point2d r1 = project_rectified(R1[0], P[0], points[i]);
+            cv::Point2d r2 = project_rectified(R1[0], P[1], points[i]);
+            fprintf(truth, "%d,%d,%.6f,%.6f,%.6f,%.3f,%.3f,%.3f,%.3f\n", f, i, points[i].x, points[i].y, points[i].z,
+                    r1.x, r1.y, r2.x, r2.y);
+        }
+
+        for (int c = 0; c < 2; c++) {
+            projectPoints(points, rvec[c], tvec[c], CM[c], D[c], projected);
+
+            cv::Mat rotation;
+            Rodrigues(rvec[c], rotation);
+            for (int i = 0; i < nBalloons; i++) {
+                cv::Mat x = rotation * (cv::Mat_<double>(3, 1) << points[i].x, points[i].y, points[i].z) + tvec[c];
+                depth[i] = x.at<double>(2);
+                order[i] = i;
+            }
+
+            // the far balloons first, so the near ones cover them
+            std::sort(order.begin(), order.end(), [&depth](int a, int b) { return depth[a] > depth[b]; });
+
+            backgrounds[c].copyTo(frame);
+            for (int k = 0; k < nBalloons; k++) {
+                int i = order[k];
+                if (depth[i] <= 0) {
+                    continue;
+                }
+                double radius = CM[c].at<double>(0, 0) * balloonRadius / depth[i];
+                draw_balloon(frame, projected[i], radius, balloons[i].color);
+            }
+            add_noise(frame, noise, scratch, noiseImg);
+            writers[c] << frame;
+        }
+
+        for (int i = 0; i < nBalloons; i++) {
+            move_balloon(balloons[i], volume, dt);
+        }
+    }
+
+    fclose(truth);
+    std::cout << "Wrote " << nFrames << " frames of " << size.width << "x" << size.height << " with "
+            << nBalloons << " balloons, the configuration is " << configOut << "." << std::endl;
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "assignment.h"
+
+#include <limits>
+
+void AssignmentSolver::solve(const double *cost, int rows, int cols, int *assignment) {
+    const double INF = std::numeric_limits<double>::infinity();
+
+    // potentials and matching are 1-indexed, column 0 is a virtual column
+    // that holds the row currently being added
+    u.assign(rows + 1, 0);
+    v.assign(cols + 1, 0);
+    p.assign(cols + 1, 0);
+    way.assign(cols + 1, 0);
+
+    for (int i = 1; i <= rows; i++) {
+        p[0] = i;
+        int j0 = 0;
+        minv.assign(cols + 1, INF);
+        used.assign(cols + 1, 0);
+
+        // grow the alternating tree until a free column is reached
+        do {
+            used[j0] = 1;
+            int i0 = p[j0];
+            double delta = INF;
+            int j1 = 0;
+            const double *row = cost + (i0 - 1) * cols;
+            for (int j = 1; j <= cols; j++) {
+                if (!used[j]) {
+                    double cur = row[j - 1] - u[i0] - v[j];
+                    if (cur < minv[j]) {
+                        minv[j] = cur;
+                        way[j] = j0;
+                    }
+                    if (minv[j] < delta) {
+                        delta = minv[j];
+                        j1 = j;
+                    }
+                }
+            }
+            for (int j = 0; j <= cols; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+
+        // augment along the found path
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (int j = 1; j <= cols; j++) {
+        if (p[j] != 0) {
+            assignment[p[j] - 1] = j - 1;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef ASSIGNMENT_H
+#define ASSIGNMENT_H
+
+#include <vector>
+
+/**
+ * Solver for the linear assignment problem, based on the Hungarian method
+ * with row and column potentials (O(rows^2 * cols)). The working memory is
+ * kept between calls, so solving problems that are not bigger than the
+ * previous ones does not allocate.
+ */
+class AssignmentSolver {
+    std::vector<double> u;
+    std::vector<double> v;
+    std::vector<double> minv;
+    std::vector<int> p;
+    std::vector<int> way;
+    std::vector<char> used;
+public:
+    /**
+     * Finds the assignment of rows to distinct columns with the minimal total cost.
+     * @param cost Row-major cost matrix with rows*cols elements.
+     * @param rows Number of rows, must not be greater than the number of columns.
+     * @param cols Number of columns.
+     * @param assignment Output array with rows elements, receives the column assigned to each row.
+     */
+    void solve(const double *cost, int rows, int cols, int *assignment);
+};
+
+#endif
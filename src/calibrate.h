@@ -1,8 +1,8 @@
-#ifndef CALIBRATE_H
-#define CALIBRATE_H
-
-#include "config_parser.h"
-
-int calibrate(ConfigParser config);
-
+#ifndef CALIBRATE_H
+#define CALIBRATE_H
+
+#include "config_parser.h"
+
+int calibrate(ConfigParser config);
+
 #endif
\ No newline at end of file
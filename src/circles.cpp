@@ -1,208 +1,368 @@
-#include "circles.h"
-#include "util.h"
-
-#include "opencv2/highgui/highgui.hpp"
-#include "opencv2/imgproc/imgproc.hpp"
-
-#include <algorithm>
-#include <iostream>
-
-#define BORDER_THICKNESS 10
-
-static double minHit;
-static double outRegion;
-static int nCirclesObserved;
-static int maxAge;
-
-static double houghInverseRatio;
-static double houghMinDistance;
-static double houghThresholdCanny;
-static double houghThresholdAccumulator;
-static int houghMinRadius;
-static int houghMaxRadius;
-
-static int erodeSize;
-static int dilateSize;
-
-static int blurSize;
-static double blurSigma;
-
-void init_circles(ConfigParser config) {
-    minHit = config.getDouble("minHitGoodness");
-    maxAge = config.getInt("particleMaximumAge");
-    outRegion = config.getDouble("outsideRegionFactor");
-    nCirclesObserved = config.getInt("nCirclesObserved");
-    houghInverseRatio = config.getDouble("houghInverseRatio");
-    houghMinDistance = config.getDouble("houghMinDistance");
-    houghThresholdCanny = config.getDouble("houghThresholdCanny");
-    houghThresholdAccumulator = config.getDouble("houghThresholdAccumulator");
-    houghMinRadius = config.getInt("houghMinRadius");
-    houghMaxRadius = config.getInt("houghMaxRadius");
-    erodeSize = config.getInt("circleErodeSize");
-    dilateSize = config.getInt("circleDilateSize");
-    blurSize = config.getInt("circleBlurSize");
-    blurSigma = config.getDouble("circleBlurSigma");
-}
-
-static void age_and_remove_dead(std::vector<Condensation*> filters) {
-    for (int j = 0; j < filters.size(); j++) {
-        std::vector<CMeasurement>* measurements = filters[j]->getMeasurements();
-        std::vector<int> toRemove;
-        for (int i = 0; i < measurements->size(); i++) {
-            CMeasurement *m = &measurements->operator[](i);
-            m->age();
-            if (m->isDead()) {
-                toRemove.push_back(i);
-            }
-        }
-
-        for (int i = 0; i < toRemove.size(); i++) {
-            measurements->erase(measurements->begin() + toRemove[i] - i);
-        }
-    }
-}
-
-/*
- * Class that stores a data representing a circle measurement, its goodness, and the balloon it belongs to.
-*/
-class MeasurementHit {
-public:
-    int index;
-    int balloon;
-    double hit;
-    CMeasurement measurement;
-    MeasurementHit(int i, int b, double h, CMeasurement m)
-        : index(i), balloon(b), hit(h), measurement(m) {}
-};
-
-static bool sortfunction(MeasurementHit a, MeasurementHit b) {
-    return a.hit > b.hit;
-}
-
-static void match_circles_filters(std::vector<cv::Vec3f> circles, std::vector<Condensation*> filters, std::vector<cv::Rect> regions,
-                    cv::Mat originalImg) {
-    // cv::Mat drawing = originalImg.clone();
-
-    std::vector<MeasurementHit> mhs;
-
-    // observe only the best nCirclesObserved circles
-    int nc = (circles.size() < nCirclesObserved) ? circles.size() : nCirclesObserved;
-    for (int i = 0; i < nc; i++) {
-        cv::Point center(std::max(0, cvRound(circles[i][0]) - BORDER_THICKNESS), std::max(0, cvRound(circles[i][1]) - BORDER_THICKNESS));
-        // int radius = cvRound(circles[i][2]);
-        // circle(drawing, center, radius, cv::Scalar(0, 0, 255), 2);
-        for (int j = 0; j < filters.size(); j++) {
-            cv::Rect region = regions[j];
-
-            double w = 1;
-            // reduce the weight if it's out of the inspect region
-            if (center.x < region.x || center.x > region.x + region.width ||
-                    center.y < region.y || center.y > region.y + region.height) {
-                w = outRegion;
-            }
-
-            // estimate the hit goodness
-            cv::Mat mask = cv::Mat::zeros(originalImg.size(), CV_8UC1);
-            circle(mask, center, houghMinRadius, cv::Scalar(255), CV_FILLED);
-            double hit = filters[j]->estimateHit(originalImg, mask);
-            // if the hit goodness is better than the predefined threshold, add it to the measurements list
-            if (hit > minHit) {
-                mhs.push_back(MeasurementHit(i, j, hit, CMeasurement(center.x, center.y, w*hit*hit, maxAge)));
-            }
-        }
-    }
-
-    /*static int id = 0;
-    id++;
-    if (id == 5) {
-        id = 1;
-    }
-    imshow(concat("Drawing", id), drawing);*/
-
-    // circle measurements are matched to the balloons in a fashion that
-    // the best measurement for each balloon is added to the measurements list of the corresponding filter,
-    // but keeping in mind that the same masurement can't be matched to more than one balloon
-    
-    sort(mhs.begin(), mhs.end(), sortfunction);
-
-    bool *bm = new bool[nc]();
-    bool *bb = new bool[filters.size()]();
-
-    for (int i = 0; i < mhs.size(); i++) {
-        if (!bm[mhs[i].index] && !bb[mhs[i].balloon]) {
-            filters[mhs[i].balloon]->getMeasurements()->push_back(mhs[i].measurement);
-            bm[mhs[i].index] = true;
-            bb[mhs[i].balloon] = true;
-        }
-    }
-
-    delete bm;
-    delete bb;
-}
-
-void update_circles(cv::Mat motionImg, cv::Mat originalImg, std::vector<Condensation*> filters, std::vector<cv::Rect> regions) {
-    if (filters.size() != regions.size()) {
-        std::cerr << "Vector dimensions don't match!" << std::endl;
-        return;
-    }
-    
-    age_and_remove_dead(filters);
-    
-    // adding a border to cover the cases when the balloon is on the edge of the frame
-    int b = BORDER_THICKNESS;
-    cv::Mat motionImg_border;
-    copyMakeBorder(motionImg, motionImg_border, b, b, b, b, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
-    
-    // converting the motion image to gray
-    cv::Mat motionImg_gray;
-    cvtColor(motionImg_border, motionImg_gray, CV_BGR2GRAY);
-    
-    // this part of code was removed due to ineffectiveness
-    /*// apply Gaussian blur
-    cv::Mat motionImg_blurred;
-    GaussianBlur(motionImg_gray, motionImg_blurred, cv::Size(blurSize, blurSize), blurSigma, blurSigma);
-    
-    // find circles
-    std::vector<cv::Vec3f> circles;
-    HoughCircles(motionImg_blurred, circles, CV_HOUGH_GRADIENT, houghInverseRatio, houghMinDistance,
-            80, 10, houghMinRadius, houghMaxRadius); // TODO 80,10
-    
-    match_circles_filters(circles, filters, regions, originalImg);
-    circles.clear();
-    */
-    
-    // thresholding in a manner that every non-zero pixel from the image gets maximum value
-    cv::Mat motionImg_bin;
-    threshold(motionImg_gray, motionImg_bin, 0, 255, cv::THRESH_BINARY);
-    
-    // morphological opening
-    int es = erodeSize;
-    int ds = dilateSize;
-    int ep = (erodeSize - 1) / 2 - 1;
-    int dp = (dilateSize - 1) / 2 - 1;
-    erode(motionImg_bin, motionImg_bin, getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(es, es), cv::Point(ep, ep)));
-    dilate(motionImg_bin, motionImg_bin, getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(ds, ds), cv::Point(dp, dp)));
-    
-    // adding border to the original image
-    cv::Mat originalImg_border;
-    copyMakeBorder(originalImg, originalImg_border, b, b, b, b,  cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
-    
-    // extract only the part of the original image that's moving
-    cv::Mat originalImgM_border;
-    originalImg_border.copyTo(originalImgM_border, motionImg_bin);
-    
-    // convert to grayscale
-    cv::Mat originalImgM_gray;
-    cvtColor(originalImgM_border, originalImgM_gray, CV_BGR2GRAY);
-    
-    // apply Gaussian blur
-    cv::Mat originalImgM_blurred;
-    GaussianBlur(originalImgM_gray, originalImgM_blurred, cv::Size(blurSize, blurSize), blurSigma, blurSigma);
-    
-    // find circles
-    std::vector<cv::Vec3f> circles;
-    HoughCircles(originalImgM_blurred, circles, CV_HOUGH_GRADIENT, houghInverseRatio, houghMinDistance,
-            houghThresholdCanny, houghThresholdAccumulator, houghMinRadius, houghMaxRadius);
-            
-    match_circles_filters(circles, filters, regions, originalImg);
-}
+#include "circles.h"
+#include "profiler.h"
+#include "util.h"
+
+#include "opencv2/highgui/highgui.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+static double minHit;
+static double outRegion;
+static int nCirclesObserved;
+static int maxAge;
+static double distanceWeight;
+
+static double houghInverseRatio;
+static double houghMinDistance;
+static double houghThresholdCanny;
+static double houghThresholdAccumulator;
+static int houghMinRadius;
+static int houghMaxRadius;
+
+#define DETECTOR_HOUGH 0
+#define DETECTOR_BLOBS 1
+
+static int detector;
+static double minCircularity;
+
+static int erodeSize;
+static int dilateSize;
+
+static int blurSize;
+static double blurSigma;
+
+void init_circles(ConfigParser config) {
+    configure_circles(config);
+    houghMinRadius = config.getInt("houghMinRadius");
+    detector = (strcmp(config.getString("circleDetector", "hough"), "blobs") == 0) ? DETECTOR_BLOBS : DETECTOR_HOUGH;
+    erodeSize = config.getInt("circleErodeSize");
+    dilateSize = config.getInt("circleDilateSize");
+    blurSize = config.getInt("circleBlurSize");
+    blurSigma = config.getDouble("circleBlurSigma");
+}
+
+void configure_circles(ConfigParser config) {
+    minHit = config.getDouble("minHitGoodness");
+    maxAge = config.getInt("particleMaximumAge");
+    distanceWeight = config.getDouble("assignmentDistanceWeight", 1.0);
+    outRegion = config.getDouble("outsideRegionFactor");
+    nCirclesObserved = config.getInt("nCirclesObserved");
+    houghInverseRatio = config.getDouble("houghInverseRatio");
+    houghMinDistance = config.getDouble("houghMinDistance");
+    houghThresholdCanny = config.getDouble("houghThresholdCanny");
+    houghThresholdAccumulator = config.getDouble("houghThresholdAccumulator");
+    houghMaxRadius = config.getInt("houghMaxRadius");
+    minCircularity = config.getDouble("blobMinCircularity", 0.7);
+}
+
+void CirclesWorkspace::init(int width, int height) {
+    int b = BORDER_THICKNESS;
+    int pw = width + 2*b;
+    int ph = height + 2*b;
+    
+    motionImg_bin.create(ph, pw, CV_8UC1);
+    originalImgM_border.create(ph, pw, CV_8UC3);
+    originalImgM_gray.create(ph, pw, CV_8UC1);
+    originalImgM_blurred.create(ph, pw, CV_8UC1);
+    blobs.create(ph, pw, CV_8UC1);
+    hitMask.create(2*houghMinRadius + 1, 2*houghMinRadius + 1, CV_8UC1);
+    
+    // morphological opening
+    int es = erodeSize;
+    int ds = dilateSize;
+    int ep = (erodeSize - 1) / 2 - 1;
+    int dp = (dilateSize - 1) / 2 - 1;
+    maskFilter.init(getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(es, es), cv::Point(ep, ep)), cv::Point(-1, -1),
+            getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(ds, ds), cv::Point(dp, dp)), cv::Point(-1, -1));
+}
+
+static bool is_dead(CMeasurement m) {
+    return m.isDead();
+}
+
+static void age_and_remove_dead(const std::vector<Condensation*> &filters) {
+    for (int j = 0; j < filters.size(); j++) {
+        std::vector<CMeasurement>* measurements = filters[j]->getMeasurements();
+        for (int i = 0; i < measurements->size(); i++) {
+            measurements->operator[](i).age();
+        }
+        measurements->erase(std::remove_if(measurements->begin(), measurements->end(), is_dead), measurements->end());
+    }
+}
+
+/*
+ * Returns a view of the part of the workspace buffer with the given size.
+*/
+static cv::Mat scratch(cv::Mat buffer, cv::Size size) {
+    return buffer(cv::Rect(0, 0, size.width, size.height));
+}
+
+static void match_circles_filters(const std::vector<cv::Vec3f> &circles, const std::vector<Condensation*> &filters,
+                    const std::vector<cv::Rect> &regions, cv::Mat originalImg, CirclesWorkspace *ws) {
+    // cv::Mat drawing = originalImg.clone();
+
+    // observe only the best nCirclesObserved circles
+    int nc = (circles.size() < nCirclesObserved) ? circles.size() : nCirclesObserved;
+    int nf = filters.size();
+    if (nc == 0 || nf == 0) {
+        return;
+    }
+
+    // the cost matrix has a column for each circle, followed by one dummy column
+    // per filter which stands for leaving that filter without a measurement
+    int cols = nc + nf;
+    std::vector<double> &hits = ws->hits;
+    std::vector<double> &weights = ws->weights;
+    std::vector<double> &costs = ws->costs;
+    hits.resize(nf * nc);
+    weights.resize(nf * nc);
+    costs.resize(nf * cols);
+    ws->assignment.resize(nf);
+
+    // any acceptable circle has to be cheaper than leaving the filter unmatched
+    double diagonal = sqrt((double) originalImg.cols * originalImg.cols + (double) originalImg.rows * originalImg.rows);
+    double unmatchedCost = (1 - minHit) + distanceWeight + 1;
+    cv::Rect frame(0, 0, originalImg.cols, originalImg.rows);
+    int r = houghMinRadius;
+
+    for (int i = 0; i < nc; i++) {
+        cv::Point center(std::max(0, cvRound(circles[i][0]) - BORDER_THICKNESS), std::max(0, cvRound(circles[i][1]) - BORDER_THICKNESS));
+        // int radius = cvRound(circles[i][2]);
+        // circle(drawing, center, radius, cv::Scalar(0, 0, 255), 2);
+        
+        // the color mean is calculated only over the bounding box of the circle
+        cv::Rect box = cv::Rect(center.x - r, center.y - r, 2*r + 1, 2*r + 1) & frame;
+        cv::Mat mask, boxImg;
+        if (box.area() > 0) {
+            mask = scratch(ws->hitMask, box.size());
+            mask.setTo(cv::Scalar::all(0));
+            circle(mask, center - box.tl(), r, cv::Scalar(255), CV_FILLED);
+            boxImg = originalImg(box);
+        }
+        
+        for (int j = 0; j < nf; j++) {
+            cv::Rect region = regions[j];
+
+            double w = 1;
+            // reduce the weight if it's out of the inspect region
+            if (center.x < region.x || center.x > region.x + region.width ||
+                    center.y < region.y || center.y > region.y + region.height) {
+                w = outRegion;
+            }
+
+            // estimate the hit goodness
+            double hit = (box.area() > 0) ? filters[j]->estimateHit(boxImg, mask) : 0;
+            hits[j*nc + i] = hit;
+            weights[j*nc + i] = w*hit*hit;
+
+            // combine the color score with the distance to the predicted position,
+            // circles that aren't good enough are never preferred over no measurement
+            if (hit > minHit) {
+                cv::Mat prediction = filters[j]->getPrediction();
+                double dist = 0;
+                if (!prediction.empty()) {
+                    double dx = prediction.at<float>(0) - center.x;
+                    double dy = prediction.at<float>(1) - center.y;
+                    dist = std::min(1., sqrt(dx*dx + dy*dy) / diagonal);
+                }
+                costs[j*cols + i] = (1 - hit) + distanceWeight * dist;
+            } else {
+                costs[j*cols + i] = unmatchedCost + 1;
+            }
+        }
+    }
+
+    for (int j = 0; j < nf; j++) {
+        for (int k = 0; k < nf; k++) {
+            costs[j*cols + nc + k] = unmatchedCost;
+        }
+    }
+
+    /*static int id = 0;
+    id++;
+    if (id == 5) {
+        id = 1;
+    }
+    imshow(concat("Drawing", id), drawing);*/
+
+    // circle measurements are matched to the balloons by the globally optimal assignment,
+    // keeping in mind that the same measurement can't be matched to more than one balloon
+    ws->solver.solve(&costs[0], nf, cols, &ws->assignment[0]);
+
+    for (int j = 0; j < nf; j++) {
+        int i = ws->assignment[j];
+        if (i < nc && hits[j*nc + i] > minHit) {
+            cv::Point center(std::max(0, cvRound(circles[i][0]) - BORDER_THICKNESS), std::max(0, cvRound(circles[i][1]) - BORDER_THICKNESS));
+            filters[j]->getMeasurements()->push_back(CMeasurement(center.x, center.y, weights[j*nc + i], maxAge));
+        }
+    }
+}
+
+/*
+ * Finds circles in the moving part of the original image using the Hough transform.
+ * Both images need to be of the same size, not bigger than the workspace buffers.
+ * The blurred image is reallocated only when its size changes.
+*/
+static void find_hough_circles(cv::Mat motionImg_bin, cv::Mat originalImg_border, std::vector<cv::Vec3f> &circles,
+                    cv::Mat &originalImgM_blurred, CirclesWorkspace *ws) {
+    cv::Size size = motionImg_bin.size();
+    
+    // extract only the part of the original image that's moving
+    cv::Mat originalImgM_border = scratch(ws->originalImgM_border, size);
+    originalImgM_border.setTo(cv::Scalar::all(0));
+    originalImg_border.copyTo(originalImgM_border, motionImg_bin);
+    
+    // convert to grayscale
+    cv::Mat originalImgM_gray = scratch(ws->originalImgM_gray, size);
+    cvtColor(originalImgM_border, originalImgM_gray, CV_BGR2GRAY);
+    
+    // apply Gaussian blur; the grayscale image is a view into a bigger buffer, whose stale pixels
+    // must not be read as its border, and the Canny edges of HoughCircles can't be isolated
+    // the same way, so the blurred image is a Mat of its own
+    GaussianBlur(originalImgM_gray, originalImgM_blurred, cv::Size(blurSize, blurSize), blurSigma, blurSigma,
+            cv::BORDER_DEFAULT | cv::BORDER_ISOLATED);
+    
+    HoughCircles(originalImgM_blurred, circles, CV_HOUGH_GRADIENT, houghInverseRatio, houghMinDistance,
+            houghThresholdCanny, houghThresholdAccumulator, houghMinRadius, houghMaxRadius);
+}
+
+static bool compare_blobs(const std::pair<double, cv::Vec3f> &a, const std::pair<double, cv::Vec3f> &b) {
+    return a.first > b.first;
+}
+
+/*
+ * Finds circles as the connected components of the motion mask. Blobs that are round enough and
+ * whose size fits the allowed radius range are taken as circles directly, while the ambiguous ones
+ * (e.g. two balloons touching) are searched with the Hough transform inside their bounding box only.
+*/
+static void find_blob_circles(cv::Mat motionImg_bin, cv::Mat originalImg_border, std::vector<cv::Vec3f> &circles,
+                    CirclesWorkspace *ws) {
+    // findContours modifies its input
+    cv::Mat blobs = scratch(ws->blobs, motionImg_bin.size());
+    motionImg_bin.copyTo(blobs);
+    std::vector<std::vector<cv::Point> > &contours = ws->contours;
+    findContours(blobs, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
+    
+    std::vector<std::pair<double, cv::Vec3f> > &found = ws->blobCircles;
+    std::vector<cv::Vec3f> &ambiguous = ws->ambiguous;
+    found.clear();
+    ambiguous.clear();
+    cv::Rect frame(0, 0, motionImg_bin.cols, motionImg_bin.rows);
+    
+    for (int i = 0; i < contours.size(); i++) {
+        cv::Point2f center;
+        float radius;
+        minEnclosingCircle(contours[i], center, radius);
+        if (radius < houghMinRadius) {
+            continue;
+        }
+        
+        double area = contourArea(contours[i]);
+        double perimeter = arcLength(contours[i], true);
+        double circularity = (perimeter > 0) ? 4 * CV_PI * area / (perimeter * perimeter) : 0;
+        
+        if (radius <= houghMaxRadius && circularity >= minCircularity) {
+            found.push_back(std::make_pair(circularity, cv::Vec3f(center.x, center.y, radius)));
+            continue;
+        }
+        
+        // fall back to the Hough transform inside the blob
+        cv::Rect roi = boundingRect(contours[i]);
+        roi.x -= houghMaxRadius;
+        roi.y -= houghMaxRadius;
+        roi.width += 2 * houghMaxRadius;
+        roi.height += 2 * houghMaxRadius;
+        roi &= frame;
+        
+        std::vector<cv::Vec3f> &roiCircles = ws->roiCircles;
+        find_hough_circles(motionImg_bin(roi), originalImg_border(roi), roiCircles, ws->blobImgM_blurred, ws);
+        for (int j = 0; j < roiCircles.size(); j++) {
+            ambiguous.push_back(cv::Vec3f(roiCircles[j][0] + roi.x, roiCircles[j][1] + roi.y, roiCircles[j][2]));
+        }
+    }
+    
+    // the roundest blobs are the most likely balloons, so they are observed first
+    std::stable_sort(found.begin(), found.end(), compare_blobs);
+    
+    circles.clear();
+    for (int i = 0; i < found.size(); i++) {
+        circles.push_back(found[i].second);
+    }
+    circles.insert(circles.end(), ambiguous.begin(), ambiguous.end());
+}
+
+/*
+ * Returns the image extended by BORDER_THICKNESS on each side. If the image is a view into a buffer
+ * that already has the (zeroed) margin around it, the result is a view as well, otherwise the image
+ * is copied into the padded buffer of the workspace.
+*/
+static cv::Mat bordered_view(cv::Mat img, CirclesWorkspace *ws) {
+    int b = BORDER_THICKNESS;
+    cv::Size whole;
+    cv::Point ofs;
+    img.locateROI(whole, ofs);
+    if (ofs.x >= b && ofs.y >= b && whole.width - ofs.x - img.cols >= b && whole.height - ofs.y - img.rows >= b) {
+        cv::Mat view = img;
+        view.adjustROI(b, b, b, b);
+        return view;
+    }
+    copyMakeBorder(img, ws->originalImg_padded, b, b, b, b, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+    return ws->originalImg_padded;
+}
+
+void update_circles(cv::Mat motionMask, cv::Mat originalImg, const std::vector<Condensation*> &filters,
+                    const std::vector<cv::Rect> &regions, CirclesWorkspace *ws) {
+    if (filters.size() != regions.size()) {
+        std::cerr << "Vector dimensions don't match!" << std::endl;
+        return;
+    }
+    
+    age_and_remove_dead(filters);
+    
+    // this part of code was removed due to ineffectiveness
+    /*// apply Gaussian blur
+    cv::Mat motionImg_blurred;
+    GaussianBlur(motionImg_gray, motionImg_blurred, cv::Size(blurSize, blurSize), blurSigma, blurSigma);
+    
+    // find circles
+    std::vector<cv::Vec3f> circles;
+    HoughCircles(motionImg_blurred, circles, CV_HOUGH_GRADIENT, houghInverseRatio, houghMinDistance,
+            80, 10, houghMinRadius, houghMaxRadius); // TODO 80,10
+    
+    match_circles_filters(circles, filters, regions, originalImg);
+    circles.clear();
+    */
+    
+    // a border is needed to cover the cases when the balloon is on the edge of the frame,
+    // so the cleaned mask is written directly into a padded buffer
+    int b = BORDER_THICKNESS;
+    cv::Mat motionImg_bin = scratch(ws->motionImg_bin, cv::Size(motionMask.cols + 2*b, motionMask.rows + 2*b));
+    
+    // thresholding in a manner that every non-zero pixel of the mask gets maximum value,
+    // followed by morphological opening
+    {
+        PROFILE_SCOPE(STAGE_MORPHOLOGY);
+        ws->maskFilter.apply(motionMask, motionImg_bin, cv::Point(b, b));
+    }
+    
+    // the original image with the border around it
+    cv::Mat originalImg_border = bordered_view(originalImg, ws);
+    
+    // find circles
+    std::vector<cv::Vec3f> &circles = ws->circles;
+    {
+        PROFILE_SCOPE(STAGE_DETECTION);
+        if (detector == DETECTOR_BLOBS) {
+            find_blob_circles(motionImg_bin, originalImg_border, circles, ws);
+        } else {
+            find_hough_circles(motionImg_bin, originalImg_border, circles, ws->originalImgM_blurred, ws);
+        }
+    }
+    
+    PROFILE_SCOPE(STAGE_MATCHING);
+    match_circles_filters(circles, filters, regions, originalImg, ws);
+}
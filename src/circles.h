@@ -1,15 +1,75 @@
-#ifndef CIRCLES_H
-#define CIRCLES_H
-
-#include "condensation.h"
-#include "config_parser.h"
-
-#include "opencv2/core/core.hpp"
-
-#include <vector>
-
-void init_circles(ConfigParser config);
-
-void update_circles(cv::Mat motionImg, cv::Mat originalImg, std::vector<Condensation*> filters, std::vector<cv::Rect> regions);
-
-#endif
\ No newline at end of file
+#ifndef CIRCLES_H
+#define CIRCLES_H
+
+#include "assignment.h"
+#include "condensation.h"
+#include "config_parser.h"
+#include "mask_filter.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <vector>
+
+// width of the border added around the frame, so that balloons on the edge of the frame can be found
+#define BORDER_THICKNESS 10
+
+/**
+ * Buffers used by the circle detection. Each tracker owns one workspace which is
+ * allocated for its scaled frame size and reused every frame.
+ */
+class CirclesWorkspace {
+public:
+    // cleaned motion mask with the border
+    cv::Mat motionImg_bin;
+    // original image with the border, used only when the frame has no margin of its own
+    cv::Mat originalImg_padded;
+    // moving part of the original image, and its grayscale and blurred versions; the blurred
+    // images are sized exactly, of the whole frame and of the last blob searched with Hough
+    cv::Mat originalImgM_border;
+    cv::Mat originalImgM_gray;
+    cv::Mat originalImgM_blurred;
+    cv::Mat blobImgM_blurred;
+    // copy of the motion mask for the contour extraction
+    cv::Mat blobs;
+    // mask of a single circle, used for estimating the hit goodness
+    cv::Mat hitMask;
+    
+    MaskFilter maskFilter;
+    AssignmentSolver solver;
+    
+    std::vector<cv::Vec3f> circles;
+    std::vector<cv::Vec3f> roiCircles;
+    std::vector<cv::Vec3f> ambiguous;
+    std::vector<std::pair<double, cv::Vec3f> > blobCircles;
+    std::vector<std::vector<cv::Point> > contours;
+    std::vector<double> hits;
+    std::vector<double> weights;
+    std::vector<double> costs;
+    std::vector<int> assignment;
+    
+    /**
+     * Allocates the buffers for frames of the given size. Needs to be called after init_circles.
+     * @param width Width of the scaled frame.
+     * @param height Height of the scaled frame.
+     */
+    void init(int width, int height);
+};
+
+void init_circles(ConfigParser config);
+
+/*
+ * Rereads the detection thresholds that can be changed while tracking.
+ * Sizes the workspace buffers depend on are only read by init_circles.
+*/
+void configure_circles(ConfigParser config);
+
+/*
+ * Finds circles in the moving part of the image and adds them as measurements to the filters.
+ * The motion mask is the foreground mask of the frame (CV_8UC1), non-zero where the image is moving.
+ * The original image should be a view into a buffer with a zeroed BORDER_THICKNESS margin around it,
+ * otherwise it has to be copied into a padded image every frame.
+*/
+void update_circles(cv::Mat motionMask, cv::Mat originalImg, const std::vector<Condensation*> &filters,
+                    const std::vector<cv::Rect> &regions, CirclesWorkspace *ws);
+
+#endif
@@ -0,0 +1,193 @@
+#include "control_listener.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#define ADDRESS_PREFIX "/config/"
+
+// type and range of a parameter that is reread between frames, see StereoTracker::configure
+struct Parameter {
+    const char *address;
+    bool integer;
+    double min;
+    double max;
+};
+
+// bounds of the parameters that need to be above zero or aren't bounded
+static const double POSITIVE = DBL_MIN;
+static const double UNBOUNDED = HUGE_VAL;
+
+static const Parameter PARAMETERS[] = {
+    {ADDRESS_PREFIX "nParticles", true, 1, 1000000},
+    {ADDRESS_PREFIX "nNewParticles", true, 0, 1000000},
+    {ADDRESS_PREFIX "measurementSigma", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "processSigmaPosition", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "processSigmaVelocity", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "processSigmaAcceleration", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "processRandomHit", false, 0, 1},
+    {ADDRESS_PREFIX "airResistance", false, 0, 1},
+    {ADDRESS_PREFIX "gravity", false, -UNBOUNDED, UNBOUNDED},
+    {ADDRESS_PREFIX "accelerationReduction", false, 0, 1},
+    {ADDRESS_PREFIX "maxAcceleration", false, 0, UNBOUNDED},
+    {ADDRESS_PREFIX "darkCircleThreshold", false, 0, 255},
+    {ADDRESS_PREFIX "particleDrawNumber", true, 1, 1000000},
+    {ADDRESS_PREFIX "inspectWidth", true, 1, 100000},
+    {ADDRESS_PREFIX "inspectHeight", true, 1, 100000},
+    {ADDRESS_PREFIX "minHitGoodness", false, 0, 1},
+    {ADDRESS_PREFIX "particleMaximumAge", true, 1, 1000000},
+    {ADDRESS_PREFIX "assignmentDistanceWeight", false, 0, UNBOUNDED},
+    {ADDRESS_PREFIX "outsideRegionFactor", false, 0, 1},
+    {ADDRESS_PREFIX "nCirclesObserved", true, 0, 1000},
+    {ADDRESS_PREFIX "houghInverseRatio", false, 1, UNBOUNDED},
+    {ADDRESS_PREFIX "houghMinDistance", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "houghThresholdCanny", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "houghThresholdAccumulator", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "houghMaxRadius", true, 0, 100000},
+    {ADDRESS_PREFIX "blobMinCircularity", false, 0, 1},
+    {ADDRESS_PREFIX "processNoise", false, POSITIVE, UNBOUNDED},
+    {ADDRESS_PREFIX "measurementNoise", false, POSITIVE, UNBOUNDED}
+};
+
+#define N_PARAMETERS (sizeof(PARAMETERS) / sizeof(PARAMETERS[0]))
+
+static const Parameter* find_parameter(const std::string &key) {
+    for (int i = 0; i < N_PARAMETERS; i++) {
+        if (key == PARAMETERS[i].address + strlen(ADDRESS_PREFIX)) {
+            return &PARAMETERS[i];
+        }
+    }
+    return NULL;
+}
+
+// checks that the whole value is a number of the parameter's type within its range
+static bool is_valid(const Parameter &p, const std::string &value) {
+    const char *begin = value.c_str();
+    char *end;
+    double v = p.integer ? (double) strtol(begin, &end, 10) : strtod(begin, &end);
+    if (end == begin || *end != '\0' || !std::isfinite(v)) {
+        return false;
+    }
+    return v >= p.min && v <= p.max;
+}
+
+static void print_rejected(const Parameter &p, const std::string &key, const std::string &value) {
+    std::cerr << "Rejected " << key << " = " << value << ", it needs to be " << (p.integer ? "an integer" : "a number");
+    std::streamsize precision = std::cerr.precision(p.integer ? 10 : 6);
+    if (p.min == POSITIVE) {
+        std::cerr << " above 0";
+    } else if (p.min > -UNBOUNDED) {
+        std::cerr << " from " << p.min;
+    }
+    if (p.max < UNBOUNDED) {
+        std::cerr << " up to " << p.max;
+    }
+    std::cerr << "." << std::endl;
+    std::cerr.precision(precision);
+}
+
+ControlListener::ControlListener(ConfigParser config) {
+    for (int i = 0; i < N_PARAMETERS; i++) {
+        RegisterMessageFunction(PARAMETERS[i].address, &ControlListener::setParameter);
+    }
+    
+    // only local senders can change the parameters unless controlAddress names another interface,
+    // 0.0.0.0 accepts them on all of them
+    const char *address = config.getString("controlAddress", "127.0.0.1");
+    IpEndpointName endpoint(address, config.getInt("controlPort"));
+    if (endpoint.address == 0 && strcmp(address, "0.0.0.0") != 0) {
+        throw std::runtime_error(std::string("unable to resolve controlAddress ") + address + "\n");
+    }
+    socket = new UdpListeningReceiveSocket(endpoint, this);
+    listenerThread = std::thread(&UdpListeningReceiveSocket::Run, socket);
+}
+
+ControlListener::~ControlListener() {
+    socket->AsynchronousBreak();
+    listenerThread.join();
+    delete socket;
+}
+
+void ControlListener::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint) {
+    // a malformed packet must not stop the listener thread
+    try {
+        osc::MessageMappingOscPacketListener<ControlListener>::ProcessPacket(data, size, remoteEndpoint);
+    } catch (osc::Exception &e) {
+        std::cerr << "Error in control message: " << e.what() << std::endl;
+    }
+}
+
+void ControlListener::setParameter(const osc::ReceivedMessage &m, const char *address,
+        const IpEndpointName &remoteEndpoint) {
+    if (m.ArgumentCount() != 1) {
+        std::cerr << "Control message " << address << " needs exactly one argument." << std::endl;
+        return;
+    }
+    
+    osc::ReceivedMessage::const_iterator arg = m.ArgumentsBegin();
+    std::ostringstream value;
+    if (arg->IsInt32()) {
+        value << arg->AsInt32();
+    } else if (arg->IsInt64()) {
+        value << arg->AsInt64();
+    } else if (arg->IsFloat()) {
+        value.precision(9);
+        value << arg->AsFloat();
+    } else if (arg->IsDouble()) {
+        value.precision(17);
+        value << arg->AsDouble();
+    } else if (arg->IsString()) {
+        value << arg->AsString();
+    } else {
+        std::cerr << "Control message " << address << " has an unsupported argument type." << std::endl;
+        return;
+    }
+    
+    // the address of the parameter, as a pattern like /config/hough* matches several of them
+    std::string key(address + strlen(ADDRESS_PREFIX));
+    
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pending.push_back(std::make_pair(key, value.str()));
+}
+
+bool ControlListener::apply(ConfigParser *config) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (pending.empty()) {
+            return false;
+        }
+        applying.swap(pending);
+    }
+    
+    // a bad value could crash the filters (e.g. no particles) or silently read as 0
+    bool changed = false;
+    for (int i = 0; i < applying.size(); i++) {
+        const std::string &key = applying[i].first;
+        const std::string &value = applying[i].second;
+        const Parameter *p = find_parameter(key);
+        if (p == NULL) {
+            std::cerr << "Rejected " << key << ", it can't be changed while tracking." << std::endl;
+            continue;
+        }
+        if (!is_valid(*p, value)) {
+            print_rejected(*p, key, value);
+            continue;
+        }
+        // houghMinRadius is only read at startup, a smaller maximum would leave no radius to search
+        if (key == "houghMaxRadius" && atoi(value.c_str()) < config->getInt("houghMinRadius")) {
+            std::cerr << "Rejected " << key << " = " << value << ", it needs to be at least houghMinRadius = "
+                    << config->getInt("houghMinRadius") << "." << std::endl;
+            continue;
+        }
+        config->set(key, value);
+        std::cout << "Set " << key << " = " << value << std::endl;
+        changed = true;
+    }
+    applying.clear();
+    
+    return changed;
+}
@@ -0,0 +1,53 @@
+#ifndef CONTROL_LISTENER_H
+#define CONTROL_LISTENER_H
+
+#include "config_parser.h"
+
+#include "osc/MessageMappingOscPacketListener.h"
+#include "ip/UdpSocket.h"
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Listener for parameter updates sent over OSC to controlPort on
+ * controlAddress, the loopback interface by default. A message
+ * /config/<key> with a single numeric or string argument sets the value of
+ * the key, an OSC address pattern such as /config/hough* sets every key it
+ * matches. Only the parameters that can be changed while tracking are
+ * accepted, with values of their type and range. The messages are received
+ * on a background thread and queued until apply is called between frames,
+ * so a frame always sees a consistent set of parameters.
+ */
+class ControlListener : public osc::MessageMappingOscPacketListener<ControlListener> {
+    UdpListeningReceiveSocket *socket;
+    std::thread listenerThread;
+    
+    std::mutex pendingMutex;
+    std::vector<std::pair<std::string, std::string> > pending;
+    std::vector<std::pair<std::string, std::string> > applying;
+    
+    void setParameter(const osc::ReceivedMessage &m, const char *address, const IpEndpointName &remoteEndpoint);
+public:
+    /**
+     * Starts listening on controlPort.
+     * @param config Configuration with the address and port number.
+     * @throws std::runtime_error If the address can't be resolved or bound.
+     */
+    ControlListener(ConfigParser config);
+    ~ControlListener();
+    
+    /**
+     * Stores the updates received since the last call into the configuration.
+     * @param config Configuration to update.
+     * @return True if any value was changed.
+     */
+    bool apply(ConfigParser *config);
+    
+    virtual void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint);
+};
+
+#endif
@@ -1,144 +1,166 @@
-#include "calibrate.h"
-#include "circles.h"
-#include "config_parser.h"
-#include "plot.h"
-#include "send_osc.h"
-#include "superior_kalman.h"
-#include "util.h"
-#include "video_tracker.h"
-
-#include "opencv2/highgui/highgui.hpp"
-
-#include <chrono>
-#include <iostream>
-#include <string>
-#include <vector>
-
-#define ESC 27
-
-static double xAxisRatio;
-static double yAxisRatio;
-static double zAxisRatio;
-
-static BalloonPlot **plots;
-
-static void process_estimated_states(int nBalloons, VideoTracker *tracker1, VideoTracker *tracker2,
-            std::vector<SuperiorKalman> *supKalmans, MyOSCSender *sender) {
-    for (int i = 0; i < nBalloons; i++) {
-        double xe1 = tracker1->getStateX(i) * xAxisRatio;
-        double ye1 = tracker1->getStateY(i) * yAxisRatio;
-        double xe2 = tracker2->getStateX(i) * xAxisRatio;
-        double ye2 = tracker2->getStateY(i) * yAxisRatio;
-
-        double U = xe1;
-        double V = (ye1 + ye2)/2;
-        if (xe2 == xe1) {
-            xe2 = xe1 + xAxisRatio;
-        }
-        double W = zAxisRatio / abs(xe2-xe1);
-
-        supKalmans->operator[](i).predict();
-        cv::Mat position = supKalmans->operator[](i).correct((cv::Mat_<float>(3,1) << U, V, W));
-        float x = position.at<float>(0, 0);
-        float y = position.at<float>(1, 0);
-        float z = position.at<float>(2, 0);
-        sender->sendPosition(i, x, y, z);
-        // sender->sendPosition(i, U, V, W);
-        
-        // std::cout << "p1 " << U << ' ' << V << ' ' << W << " p2 " << x << ' ' << y << ' ' << z << std::endl;
-        
-        if (plots[i] != NULL) {
-            plots[i]->update(x, y, z);
-        }
-    }
-}
-
-int main(int argc, char** argv) {
-    if (argc != 2) {
-        std::cout << "Program expects exactly one argument, path to the configuration file." << std::endl;
-        return -1;
-    }
-
-    ConfigParser config;
-    config.parse(argv[1]);
-
-    int calib = config.getInt("calibrate");
-    if (calib) {
-        calibrate(config);
-    }
-
-    int nBalloons = config.getInt("nBalloons");
-    
-    xAxisRatio = config.getDouble("xAxisRatio");
-    yAxisRatio = config.getDouble("yAxisRatio");
-    zAxisRatio = config.getDouble("zAxisRatio");
-    
-    init_circles(config);
-    
-    MyOSCSender sender(config);
-    
-    std::vector<SuperiorKalman> supKalmans(nBalloons, SuperiorKalman(config));
-    
-    VideoTracker tracker1(0);
-    VideoTracker tracker2(1);
-    
-    tracker1.init(config);
-    tracker2.init(config);
-    
-    double sw = tracker1.getScaledWidth();
-    double sh = tracker1.getScaledHeight();
-    if (abs(tracker2.getScaledWidth()-sw) >= 1 || abs(tracker2.getScaledHeight()-sh) >= 1) {
-        std::cerr << "Video frames need to have the same size ratio." << std::endl;
-        return -1;
-    }
-    
-    plots = new BalloonPlot*[nBalloons];
-    int balloonPoints = config.getInt("balloonPoints");
-    for (int i = 0; i < nBalloons; i++) {
-        if (config.getInt(concat("showBalloonPlot", i+1))) {
-            plots[i] = new BalloonPlot(i, sw*xAxisRatio, sh*yAxisRatio, zAxisRatio/xAxisRatio, balloonPoints);
-        } else {
-            plots[i] = NULL;
-        }
-    }
-    
-    std::chrono::milliseconds timeStart;
-    
-    while (1) {
-        timeStart = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
-
-        int t1 = tracker1.next_frame();
-        int t2 = tracker2.next_frame();
-
-        if (t1 == -1 || t2 == -1) {
-            return -1;
-        }
-
-        if (t1 || t2) {
-            break;
-        }
-
-        process_estimated_states(nBalloons, &tracker1, &tracker2, &supKalmans, &sender);
-        
-        int diff = (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()) - timeStart).count();
-        // std::cout << "Time: " << diff << std::endl;
-        
-        bool exit = false;
-        switch (cv::waitKey(1)) {
-            case ESC:
-                exit = true;
-                break;
-        }
-
-        if (exit) {
-            break;
-        }
-    }
-    
-    for (int i = 0; i < nBalloons; i++) {
-        if (plots[i] != NULL) {
-            delete plots[i];
-        }
-    }
-    delete plots;
-}
\ No newline at end of file
+#include "calibrate.h"
+#include "config_parser.h"
+#include "control_listener.h"
+#include "plot.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "send_osc.h"
+#include "stereo_tracker.h"
+#include "util.h"
+
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static BalloonPlot **plots;
+static int *plotIds; // index of each balloon's plot in the renderer
+
+static volatile sig_atomic_t stopRequested = 0;
+
+// SIGINT and SIGTERM end the tracking loop, the only way to stop without windows
+static void on_stop_signal(int) {
+    stopRequested = 1;
+}
+
+// sends the positions of all balloons together, stamped with the capture time
+// of the older of the two frames, and passes them to the plots
+static void process_estimated_states(StereoTracker *tracker, MyOSCSender *sender, Renderer *renderer) {
+    sender->beginFrame(tracker->getCaptureTime());
+    
+    for (int i = 0; i < tracker->getBalloonCount(); i++) {
+        cv::Point3f p = tracker->getPosition(i);
+        sender->addPosition(i, p.x, p.y, p.z, tracker->getConfidence(i));
+        
+        if (plots[i] != NULL) {
+            renderer->submitPosition(plotIds[i], p.x, p.y, p.z);
+        }
+    }
+    
+    PROFILE_SCOPE(STAGE_OSC_SEND);
+    sender->sendFrame();
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cout << "Program expects exactly one argument, path to the configuration file." << std::endl;
+        return -1;
+    }
+
+    ConfigParser config;
+    config.parse(argv[1]);
+
+    int calib = config.getInt("calibrate");
+    if (calib) {
+        calibrate(config);
+    }
+
+    int nBalloons = config.getInt("nBalloons");
+    
+    init_profiler(config);
+    
+    MyOSCSender sender(config);
+    if (!sender.isValid()) {
+        return -1;
+    }
+    
+    StereoTracker tracker;
+    if (!tracker.init(config)) {
+        return -1;
+    }
+    VideoTracker *tracker1 = tracker.getTracker(0);
+    VideoTracker *tracker2 = tracker.getTracker(1);
+    
+    ControlListener *control = NULL;
+    if (config.getInt("controlPort", 0) > 0) {
+        try {
+            control = new ControlListener(config);
+        } catch (std::runtime_error &e) {
+            std::cerr << "Can't listen for control messages: " << e.what();
+            return -1;
+        }
+    }
+    
+    // in the headless mode there are no windows, plots or rendering thread
+    bool headless = config.getInt("headless", 0) != 0;
+    Renderer *renderer = NULL;
+    int window1 = -1;
+    int window2 = -1;
+    if (!headless) {
+        renderer = new Renderer(config);
+        window1 = renderer->addWindow(tracker1->getWindow(), tracker1->getFrameWidth(), tracker1->getFrameHeight());
+        window2 = renderer->addWindow(tracker2->getWindow(), tracker2->getFrameWidth(), tracker2->getFrameHeight());
+    }
+    
+    plots = new BalloonPlot*[nBalloons];
+    plotIds = new int[nBalloons];
+    int balloonPoints = config.getInt("balloonPoints");
+    bool plotStreaming = config.getInt("balloonPlotStreaming", 1) != 0;
+    double plotRate = config.getDouble("balloonPlotRate", 10);
+    for (int i = 0; i < nBalloons; i++) {
+        if (!headless && config.getInt(concat("showBalloonPlot", i+1))) {
+            plots[i] = new BalloonPlot(i, tracker.getWidth(), tracker.getHeight(), tracker.getDepth(), balloonPoints,
+                    plotStreaming, plotRate);
+            plotIds[i] = renderer->addPlot(plots[i], balloonPoints);
+        } else {
+            plots[i] = NULL;
+        }
+    }
+    
+    if (renderer != NULL) {
+        renderer->start();
+    }
+    
+    signal(SIGINT, on_stop_signal);
+    signal(SIGTERM, on_stop_signal);
+    
+    long long frameNumber = 0;
+    while (!stopRequested) {
+        ScopedTimer frameTimer(STAGE_FRAME, frameNumber++);
+        
+        if (control != NULL && control->apply(&config)) {
+            tracker.configure(config);
+        }
+
+        int t = tracker.next_frame();
+
+        if (t == -1) {
+            write_trace();
+            return -1;
+        }
+
+        if (t) {
+            break;
+        }
+
+        process_estimated_states(&tracker, &sender, renderer);
+        
+        if (renderer != NULL) {
+            renderer->submitFrame(window1, tracker1->getVisualFrame());
+            renderer->submitFrame(window2, tracker2->getVisualFrame());
+        }
+        
+        frameTimer.stop();
+        profile_report_if_due();
+        
+        if (renderer != NULL && renderer->exitRequested()) {
+            break;
+        }
+    }
+    
+    delete control;
+    
+    write_trace();
+    
+    // stop the rendering thread before the plots are deleted
+    delete renderer;
+    
+    for (int i = 0; i < nBalloons; i++) {
+        if (plots[i] != NULL) {
+            delete plots[i];
+        }
+    }
+    delete plots;
+    delete[] plotIds;
+}
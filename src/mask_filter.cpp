@@ -0,0 +1,163 @@
+#include "mask_filter.h"
+
+#include <algorithm>
+
+// number of destination rows processed together
+#define BAND_HEIGHT 32
+
+static const uint64_t ALL_ONES = ~(uint64_t) 0;
+
+static void collect_spans(cv::Mat element, cv::Point anchor, std::vector<int> *dys, std::vector<int> *x0s, std::vector<int> *x1s) {
+    for (int i = 0; i < element.rows; i++) {
+        const uchar *r = element.ptr<uchar>(i);
+        int j = 0;
+        while (j < element.cols) {
+            if (!r[j]) {
+                j++;
+                continue;
+            }
+            int s = j;
+            while (j < element.cols && r[j]) {
+                j++;
+            }
+            dys->push_back(i - anchor.y);
+            x0s->push_back(s - anchor.x);
+            x1s->push_back(j - 1 - anchor.x);
+        }
+    }
+}
+
+// -1 stands for the centre of the element, like in OpenCV's normalizeAnchor
+static cv::Point normalize_anchor(cv::Point anchor, cv::Size size) {
+    if (anchor.x == -1) {
+        anchor.x = size.width / 2;
+    }
+    if (anchor.y == -1) {
+        anchor.y = size.height / 2;
+    }
+    return anchor;
+}
+
+void MaskFilter::init(cv::Mat erodeElement, cv::Point erodeAnchor, cv::Mat dilateElement, cv::Point dilateAnchor) {
+    cv::Mat elements[2] = {erodeElement, dilateElement};
+    cv::Point anchors[2] = {normalize_anchor(erodeAnchor, erodeElement.size()),
+            normalize_anchor(dilateAnchor, dilateElement.size())};
+    std::vector<Span> *spans[2] = {&erodeSpans, &dilateSpans};
+    int *tops[2] = {&erodeTop, &dilateTop};
+    int *bottoms[2] = {&erodeBottom, &dilateBottom};
+    
+    for (int k = 0; k < 2; k++) {
+        std::vector<int> dys, x0s, x1s;
+        collect_spans(elements[k], anchors[k], &dys, &x0s, &x1s);
+        spans[k]->clear();
+        *tops[k] = 0;
+        *bottoms[k] = 0;
+        for (std::size_t i = 0; i < dys.size(); i++) {
+            Span s = {dys[i], x0s[i], x1s[i]};
+            spans[k]->push_back(s);
+            *tops[k] = std::min(*tops[k], dys[i]);
+            *bottoms[k] = std::max(*bottoms[k], dys[i]);
+        }
+    }
+    
+    words = 0;
+}
+
+// returns 64 bits of the row starting at the bit index s, bits outside the row have the fill value
+static inline uint64_t bits_at(const uint64_t *row, int words, int s, uint64_t fill) {
+    int q = (s >= 0) ? s / 64 : -((-s + 63) / 64);
+    int r = s - q * 64;
+    uint64_t lo = (q >= 0 && q < words) ? row[q] : fill;
+    if (r == 0) {
+        return lo;
+    }
+    uint64_t hi = (q + 1 >= 0 && q + 1 < words) ? row[q + 1] : fill;
+    return (lo >> r) | (hi << (64 - r));
+}
+
+void MaskFilter::packRow(const uchar *src, int srcW, int ox, uint64_t *row, uint64_t tail) {
+    std::fill(row, row + words, (uint64_t) 0);
+    if (src != NULL) {
+        for (int x = 0; x < srcW; x++) {
+            int bx = x + ox;
+            row[bx >> 6] |= (uint64_t) (src[x] != 0) << (bx & 63);
+        }
+    }
+    row[words - 1] |= tail;
+}
+
+/*
+ * Computes one row of the erosion (AND) or the dilation (OR) of the packed rows.
+ * Rows outside the stored range are all ones for the erosion and all zeros for the dilation,
+ * which matches OpenCV's default border value for morphological operations.
+*/
+void MaskFilter::morphRow(const uint64_t *rows, int firstRow, int nRows, int y, const std::vector<Span> &spans,
+        bool erosion, uint64_t *out) {
+    uint64_t fill = erosion ? ALL_ONES : 0;
+    std::fill(out, out + words, fill);
+    for (std::size_t k = 0; k < spans.size(); k++) {
+        const Span &s = spans[k];
+        int ry = y + s.dy - firstRow;
+        if (ry < 0 || ry >= nRows) {
+            // the whole span is outside the image, so it doesn't change the result
+            continue;
+        }
+        const uint64_t *row = rows + ry * words;
+        for (int w = 0; w < words; w++) {
+            uint64_t acc = out[w];
+            for (int o = s.x0; o <= s.x1; o++) {
+                uint64_t b = bits_at(row, words, w * 64 + o, fill);
+                acc = erosion ? (acc & b) : (acc | b);
+            }
+            out[w] = acc;
+        }
+    }
+}
+
+void MaskFilter::apply(cv::Mat src, cv::Mat dst, cv::Point offset) {
+    int w = dst.cols;
+    int h = dst.rows;
+    words = (w + 63) / 64;
+    
+    // bits past the right edge of the image are outside of it, ones for the erosion and zeros for the dilation
+    uint64_t tail = (w % 64) ? (ALL_ONES << (w % 64)) : 0;
+    
+    int bandRows = BAND_HEIGHT;
+    int maxEroded = bandRows + dilateBottom - dilateTop;
+    int maxPacked = maxEroded + erodeBottom - erodeTop;
+    packed.resize(maxPacked * words);
+    eroded.resize(maxEroded * words);
+    line.resize(words);
+    
+    for (int y0 = 0; y0 < h; y0 += bandRows) {
+        int y1 = std::min(h, y0 + bandRows);
+        
+        // rows of the eroded image needed by the dilation of this band
+        int e0 = std::max(0, y0 + dilateTop);
+        int e1 = std::min(h, y1 + dilateBottom);
+        // rows of the thresholded image needed by the erosion
+        int p0 = std::max(0, e0 + erodeTop);
+        int p1 = std::min(h, e1 + erodeBottom);
+        
+        for (int y = p0; y < p1; y++) {
+            int sy = y - offset.y;
+            const uchar *s = (sy >= 0 && sy < src.rows) ? src.ptr<uchar>(sy) : NULL;
+            packRow(s, src.cols, offset.x, &packed[(y - p0) * words], tail);
+        }
+        
+        for (int y = e0; y < e1; y++) {
+            uint64_t *row = &eroded[(y - e0) * words];
+            morphRow(&packed[0], p0, p1 - p0, y, erodeSpans, true, row);
+            row[words - 1] &= ~tail;
+        }
+        
+        for (int y = y0; y < y1; y++) {
+            morphRow(&eroded[0], e0, e1 - e0, y, dilateSpans, false, &line[0]);
+            
+            uchar *d = dst.ptr<uchar>(y);
+            for (int x = 0; x < w; x++) {
+                d[x] = ((line[x >> 6] >> (x & 63)) & 1) ? 255 : 0;
+            }
+        }
+    }
+}
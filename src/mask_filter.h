@@ -0,0 +1,59 @@
+#ifndef MASK_FILTER_H
+#define MASK_FILTER_H
+
+#include "opencv2/core/core.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Class which turns a foreground mask into a cleaned binary mask in a single
+ * pass. Thresholding, erosion and dilation are fused: the image is processed
+ * in bands of rows which are packed into bits, so the intermediate results
+ * stay in the cache and each operation works on 64 pixels at once.
+ * The result is the same as threshold, erode and dilate with the given
+ * structuring elements and OpenCV's default border handling.
+ */
+class MaskFilter {
+    // horizontal run of a structuring element, relative to its anchor
+    struct Span {
+        int dy;
+        int x0;
+        int x1;
+    };
+    
+    std::vector<Span> erodeSpans;
+    std::vector<Span> dilateSpans;
+    int erodeTop, erodeBottom;
+    int dilateTop, dilateBottom;
+    
+    int words;
+    std::vector<uint64_t> packed;
+    std::vector<uint64_t> eroded;
+    std::vector<uint64_t> line;
+    
+    void packRow(const uchar *src, int srcW, int ox, uint64_t *row, uint64_t tail);
+    void morphRow(const uint64_t *rows, int firstRow, int nRows, int y, const std::vector<Span> &spans,
+            bool erosion, uint64_t *out);
+public:
+    /**
+     * Initializes the filter with structuring elements.
+     * @param erodeElement Structuring element used for the erosion.
+     * @param erodeAnchor Anchor of the erosion element, -1 for the centre.
+     * @param dilateElement Structuring element used for the dilation.
+     * @param dilateAnchor Anchor of the dilation element, -1 for the centre.
+     */
+    void init(cv::Mat erodeElement, cv::Point erodeAnchor, cv::Mat dilateElement, cv::Point dilateAnchor);
+    
+    /**
+     * Thresholds and opens the mask. Every non-zero source pixel is treated as foreground.
+     * @param src Source mask (CV_8UC1).
+     * @param dst Destination mask (CV_8UC1), must be allocated. Pixel (x, y) of the destination
+     *              corresponds to the source pixel (x - offset.x, y - offset.y), destination
+     *              pixels outside the source are treated as background.
+     * @param offset Position of the source image inside the destination.
+     */
+    void apply(cv::Mat src, cv::Mat dst, cv::Point offset);
+};
+
+#endif
@@ -1,80 +1,250 @@
-/*
-	oscpack -- Open Sound Control (OSC) packet manipulation library
-    http://www.rossbencina.com/code/oscpack
-
-    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
-
-	Permission is hereby granted, free of charge, to any person obtaining
-	a copy of this software and associated documentation files
-	(the "Software"), to deal in the Software without restriction,
-	including without limitation the rights to use, copy, modify, merge,
-	publish, distribute, sublicense, and/or sell copies of the Software,
-	and to permit persons to whom the Software is furnished to do so,
-	subject to the following conditions:
-
-	The above copyright notice and this permission notice shall be
-	included in all copies or substantial portions of the Software.
-
-	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
-	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
-	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
-	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
-	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
-	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
-*/
-
-/*
-	The text above constitutes the entire oscpack license; however, 
-	the oscpack developer(s) also make the following non-binding requests:
-
-	Any person wishing to distribute modifications to the Software is
-	requested to send the modifications to the original developer so that
-	they can be incorporated into the canonical version. It is also 
-	requested that these non-binding requests be included whenever the
-	above license is reproduced.
-*/
-#ifndef INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H
-#define INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H
-
-#include <cstring>
-#include <map>
-
-#include "OscPacketListener.h"
-
-
-
-namespace osc{
-
-template< class T >
-class MessageMappingOscPacketListener : public OscPacketListener{
-public:
-    typedef void (T::*function_type)(const osc::ReceivedMessage&, const IpEndpointName&);
-
-protected:
-    void RegisterMessageFunction( const char *addressPattern, function_type f )
-    {
-        functions_.insert( std::make_pair( addressPattern, f ) );
-    }
-
-    virtual void ProcessMessage( const osc::ReceivedMessage& m,
-		const IpEndpointName& remoteEndpoint )
-    {
-        typename function_map_type::iterator i = functions_.find( m.AddressPattern() );
-        if( i != functions_.end() )
-            (dynamic_cast<T*>(this)->*(i->second))( m, remoteEndpoint );
-    }
-    
-private:
-    struct cstr_compare{
-        bool operator()( const char *lhs, const char *rhs ) const
-            { return std::strcmp( lhs, rhs ) < 0; }
-    };
-
-    typedef std::map<const char*, function_type, cstr_compare> function_map_type;
-    function_map_type functions_;
-};
-
-} // namespace osc
-
+/*
+	oscpack -- Open Sound Control (OSC) packet manipulation library
+    http://www.rossbencina.com/code/oscpack
+
+    Copyright (c) 2004-2013 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	The text above constitutes the entire oscpack license; however, 
+	the oscpack developer(s) also make the following non-binding requests:
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version. It is also 
+	requested that these non-binding requests be included whenever the
+	above license is reproduced.
+*/
+#ifndef INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H
+#define INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "OscPacketListener.h"
+
+
+
+namespace osc{
+
+// Matches an OSC address pattern against a literal address. Supports the
+// OSC 1.0 wildcards: '?' and '*' (neither matches '/'), "[abc]", "[a-z]",
+// "[!abc]" and "{foo,bar}".
+inline bool AddressPatternMatches( const char *pattern, const char *address )
+{
+    for( ;; ){
+        switch( *pattern ){
+        case '\0':
+            return *address == '\0';
+
+        case '?':
+            if( *address == '\0' || *address == '/' )
+                return false;
+            ++pattern;
+            ++address;
+            break;
+
+        case '*':
+            ++pattern;
+            for( ;; ){
+                if( AddressPatternMatches( pattern, address ) )
+                    return true;
+                if( *address == '\0' || *address == '/' )
+                    return false;
+                ++address;
+            }
+
+        case '[':
+            {
+                if( *address == '\0' || *address == '/' )
+                    return false;
+                ++pattern;
+                bool negate = false;
+                if( *pattern == '!' ){
+                    negate = true;
+                    ++pattern;
+                }
+                bool matched = false;
+                while( *pattern != '\0' && *pattern != ']' ){
+                    if( pattern[1] == '-' && pattern[2] != '\0' && pattern[2] != ']' ){
+                        if( *address >= pattern[0] && *address <= pattern[2] )
+                            matched = true;
+                        pattern += 3;
+                    }else{
+                        if( *address == *pattern )
+                            matched = true;
+                        ++pattern;
+                    }
+                }
+                if( *pattern != ']' || matched == negate )
+                    return false;
+                ++pattern;
+                ++address;
+            }
+            break;
+
+        case '{':
+            {
+                const char *end = std::strchr( pattern, '}' );
+                if( !end )
+                    return false;
+                const char *alternative = pattern + 1;
+                for( ;; ){
+                    const char *alternativeEnd = alternative;
+                    while( alternativeEnd < end && *alternativeEnd != ',' )
+                        ++alternativeEnd;
+                    std::size_t length = alternativeEnd - alternative;
+                    if( std::strncmp( alternative, address, length ) == 0
+                            && AddressPatternMatches( end + 1, address + length ) )
+                        return true;
+                    if( alternativeEnd == end )
+                        return false;
+                    alternative = alternativeEnd + 1;
+                }
+            }
+
+        default:
+            if( *pattern != *address )
+                return false;
+            ++pattern;
+            ++address;
+        }
+    }
+}
+
+
+inline bool IsAddressPattern( const char *address )
+{
+    return std::strpbrk( address, "?*[{" ) != 0;
+}
+
+
+// Calls the member function registered for the address of each message. A
+// message whose address is a pattern is passed to every function whose
+// address matches it. As AddressPattern() of the message still returns the
+// pattern, a function registered as addressed_function_type also gets the
+// address it was registered for.
+template< class T >
+class MessageMappingOscPacketListener : public OscPacketListener{
+public:
+    typedef void (T::*function_type)(const osc::ReceivedMessage&, const IpEndpointName&);
+    typedef void (T::*addressed_function_type)(const osc::ReceivedMessage&, const char *address,
+            const IpEndpointName&);
+
+protected:
+    void RegisterMessageFunction( const char *addressPattern, function_type f )
+    {
+        handler_type h = { f, 0 };
+        functions_.insert( std::make_pair( addressPattern, h ) );
+        patterns_.clear();
+    }
+
+    void RegisterMessageFunction( const char *addressPattern, addressed_function_type f )
+    {
+        handler_type h = { 0, f };
+        functions_.insert( std::make_pair( addressPattern, h ) );
+        patterns_.clear();
+    }
+
+    virtual void ProcessMessage( const osc::ReceivedMessage& m,
+		const IpEndpointName& remoteEndpoint )
+    {
+        const char *address = m.AddressPattern();
+
+        if( !IsAddressPattern( address ) ){
+            typename function_map_type::iterator i = functions_.find( address );
+            if( i != functions_.end() )
+                Call( i->first, i->second, m, remoteEndpoint );
+            return;
+        }
+
+        // a pattern is matched against all registered addresses only the
+        // first time it is received, later the matches come from the cache
+        patternKey_.assign( address );
+        typename pattern_map_type::iterator i = patterns_.find( patternKey_ );
+        if( i == patterns_.end() ){
+            if( patterns_.size() >= MAX_CACHED_PATTERNS )
+                patterns_.clear();
+            std::vector< match_type >& matches = patterns_[ patternKey_ ];
+            for( typename function_map_type::iterator j = functions_.begin(); j != functions_.end(); ++j ){
+                if( AddressPatternMatches( address, j->first ) )
+                    matches.push_back( *j );
+            }
+            i = patterns_.find( patternKey_ );
+        }
+
+        for( typename std::vector< match_type >::iterator j = i->second.begin(); j != i->second.end(); ++j )
+            Call( j->first, j->second, m, remoteEndpoint );
+    }
+    
+private:
+    enum { MAX_CACHED_PATTERNS = 256 };
+
+    // exactly one of the functions is set
+    struct handler_type{
+        function_type function;
+        addressed_function_type addressedFunction;
+    };
+
+    void Call( const char *address, const handler_type& h, const osc::ReceivedMessage& m,
+            const IpEndpointName& remoteEndpoint )
+    {
+        if( h.addressedFunction )
+            (dynamic_cast<T*>(this)->*(h.addressedFunction))( m, address, remoteEndpoint );
+        else
+            (dynamic_cast<T*>(this)->*(h.function))( m, remoteEndpoint );
+    }
+
+    // 32 bit FNV-1a
+    struct cstr_hash{
+        std::size_t operator()( const char *s ) const
+        {
+            uint32 h = 2166136261u;
+            for( ; *s; ++s ){
+                h ^= (unsigned char)*s;
+                h *= 16777619u;
+            }
+            return h;
+        }
+    };
+
+    struct cstr_equal{
+        bool operator()( const char *lhs, const char *rhs ) const
+            { return std::strcmp( lhs, rhs ) == 0; }
+    };
+
+    typedef std::unordered_map<const char*, handler_type, cstr_hash, cstr_equal> function_map_type;
+    function_map_type functions_;
+
+    // registered address and its function
+    typedef std::pair< const char*, handler_type > match_type;
+    typedef std::unordered_map< std::string, std::vector< match_type > > pattern_map_type;
+    pattern_map_type patterns_;
+    std::string patternKey_;
+};
+
+} // namespace osc
+
 #endif /* INCLUDED_OSCPACK_MESSAGEMAPPINGOSCPACKETLISTENER_H */
\ No newline at end of file
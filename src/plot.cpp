@@ -1,43 +1,83 @@
-#include "plot.h"
-#include "util.h"
-
-#include "gnuplot/gnuplot_i.hpp"
-
-#include <iostream>
-
-BalloonPlot::BalloonPlot(int id, double xRange, double yRange, double zRange, int points) {
-    this->id = id;
-    this->points = points;
-    Gnuplot* gpp = new Gnuplot("lines");
-    gp = (void*) gpp;
-    gpp->set_title(concat("Balloon ", id+1));
-    gpp->set_xlabel();
-    gpp->set_ylabel();
-    gpp->set_zlabel();
-    gpp->set_xrange(0, xRange);
-    gpp->set_yrange(0, yRange);
-    gpp->set_zrange(0, zRange);
-    gpp->showonscreen();
-}
-
-void BalloonPlot::update(double x, double y, double z) {
-    xs.push_back(x);
-    ys.push_back(y);
-    zs.push_back(z);
-    
-    if (xs.size() > points) {
-        xs.erase(xs.begin());
-        ys.erase(ys.begin());
-        zs.erase(zs.begin());
-    }
-    
-    Gnuplot* gpp = (Gnuplot*) gp;
-    gpp->reset_plot();
-    gpp->plot_xyz(xs, ys, zs, "balloon movement");
-}
-
-BalloonPlot::~BalloonPlot() {
-    Gnuplot* gpp = (Gnuplot*) gp;
-    gpp->remove_tmpfiles();
-    delete gpp;
+#include "plot.h"
+#include "util.h"
+
+#include "gnuplot/gnuplot_i.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+BalloonPlot::BalloonPlot(int id, double xRange, double yRange, double zRange, int points,
+        bool streaming, double refreshRate) : xs(points), ys(points), zs(points) {
+    this->id = id;
+    this->streaming = streaming;
+    refreshInterval = std::chrono::steady_clock::duration::zero();
+    if (refreshRate > 0) {
+        refreshInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1 / refreshRate));
+    }
+    lastRefresh = std::chrono::steady_clock::now() - refreshInterval;
+    Gnuplot* gpp = new Gnuplot("lines");
+    gp = (void*) gpp;
+    gpp->set_title(concat("Balloon ", id+1));
+    gpp->set_xlabel();
+    gpp->set_ylabel();
+    gpp->set_zlabel();
+    gpp->set_xrange(0, xRange);
+    gpp->set_yrange(0, yRange);
+    gpp->set_zrange(0, zRange);
+    gpp->showonscreen();
+}
+
+void BalloonPlot::update(double x, double y, double z) {
+    add(x, y, z);
+    refresh();
+}
+
+// only records the position
+void BalloonPlot::add(double x, double y, double z) {
+    xs.push(x);
+    ys.push(y);
+    zs.push(z);
+}
+
+// redraws the plot if the refresh interval has passed
+void BalloonPlot::refresh() {
+    if (xs.empty()) {
+        return;
+    }
+    
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - lastRefresh < refreshInterval) {
+        return;
+    }
+    lastRefresh = now;
+    
+    draw();
+}
+
+void BalloonPlot::draw() {
+    Gnuplot* gpp = (Gnuplot*) gp;
+    
+    if (!streaming) {
+        gpp->reset_plot();
+        gpp->plot_xyz(xs, ys, zs, "balloon movement");
+        return;
+    }
+    
+    // the points follow the command as an inline data block terminated by "e",
+    // everything goes through the pipe in a single write
+    commands.assign("splot '-' with lines title \"balloon movement\"\n");
+    char line[96];
+    for (int i = 0; i < xs.size(); i++) {
+        snprintf(line, sizeof(line), "%g %g %g\n", xs[i], ys[i], zs[i]);
+        commands.append(line);
+    }
+    commands.append("e");
+    gpp->cmd(commands);
+}
+
+BalloonPlot::~BalloonPlot() {
+    Gnuplot* gpp = (Gnuplot*) gp;
+    gpp->remove_tmpfiles();
+    delete gpp;
 }
\ No newline at end of file
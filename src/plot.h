@@ -1,19 +1,38 @@
-#ifndef PLOT_H
-#define PLOT_H
-
-#include <vector>
-
-class BalloonPlot {
-    int id;
-    std::vector<double> xs;
-    std::vector<double> ys;
-    std::vector<double> zs;
-    void *gp;
-    int points;
-public:
-    BalloonPlot(int id, double xRange, double yRange, double zRange, int points);
-    void update(double x, double y, double z);
-    ~BalloonPlot();
-};
-
+#ifndef PLOT_H
+#define PLOT_H
+
+#include "ring_buffer.h"
+
+#include <chrono>
+#include <string>
+
+/**
+ * Gnuplot window with the recent trajectory of a balloon. In the streaming
+ * mode the points are sent inline through the gnuplot pipe, otherwise every
+ * redraw goes through a temporary file. The plot is redrawn at most
+ * refreshRate times per second (every update if it is 0), while the points
+ * are collected every frame.
+ */
+class BalloonPlot {
+    int id;
+    // the last balloonPoints positions
+    RingBuffer<double> xs;
+    RingBuffer<double> ys;
+    RingBuffer<double> zs;
+    void *gp;
+    bool streaming;
+    std::chrono::steady_clock::duration refreshInterval;
+    std::chrono::steady_clock::time_point lastRefresh;
+    std::string commands;
+    
+    void draw();
+public:
+    BalloonPlot(int id, double xRange, double yRange, double zRange, int points,
+            bool streaming, double refreshRate);
+    void update(double x, double y, double z);
+    void add(double x, double y, double z);
+    void refresh();
+    ~BalloonPlot();
+};
+
 #endif
\ No newline at end of file
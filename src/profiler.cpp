@@ -0,0 +1,245 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char* STAGE_NAMES[STAGE_COUNT] = {
+    "frame",
+    "capture",
+    "remap",
+    "resize",
+    "predict",
+    "filter predict",
+    "mog2",
+    "morphology",
+    "detection",
+    "matching",
+    "correct",
+    "filter correct",
+    "triangulation",
+    "osc send",
+    "osc transmit"
+};
+
+static bool enabled = false;
+static std::chrono::steady_clock::duration reportInterval;
+static std::chrono::steady_clock::time_point lastReport;
+static LatencyHistogram histograms[STAGE_COUNT];
+
+struct TraceSpan {
+    ProfileStage stage;
+    int lane;
+    long long id;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+};
+
+static bool tracing = false;
+static std::string traceFile;
+static std::chrono::steady_clock::time_point traceStart;
+// ring buffer of the most recent spans, once full the oldest ones are overwritten
+static std::vector<TraceSpan> spans;
+static std::size_t nextSpan;
+static bool spansWrapped;
+static std::mutex spansMutex;
+static thread_local int traceLane = TRACE_LANE_MAIN;
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+// values below SUB_BUCKETS get a bucket each, above that the bucket is given by
+// the position of the highest bit and the SUB_BITS bits below it
+int LatencyHistogram::bucket_of(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return (int)ns;
+    }
+    int msb = 63;
+    while (!(ns >> msb)) {
+        msb--;
+    }
+    int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS + (int)((ns >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucket_top(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return (((uint64_t)SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    counts[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    uint64_t m = maximum.load(std::memory_order_relaxed);
+    while (ns > m && !maximum.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(p / 100 * n);
+    if (rank >= n) {
+        rank = n - 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            uint64_t top = bucket_top(i);
+            return top < max() ? top : max();
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::reset() {
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+void init_profiler(ConfigParser config) {
+    enabled = config.getInt("profile", 0) != 0;
+    
+    const char* file = config.getString("traceFile", NULL);
+    tracing = file != NULL;
+    if (tracing) {
+        traceFile = file;
+        std::lock_guard<std::mutex> lock(spansMutex);
+        spans.assign(std::max(config.getInt("traceBufferSize", 262144), 1), TraceSpan());
+        nextSpan = 0;
+        spansWrapped = false;
+        traceStart = std::chrono::steady_clock::now();
+    }
+    
+    reportInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(config.getDouble("profileReportInterval", 5)));
+    profile_reset();
+}
+
+void profile_reset() {
+    lastReport = std::chrono::steady_clock::now();
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        histograms[i].reset();
+    }
+}
+
+bool profiling_enabled() {
+    return enabled || tracing;
+}
+
+void profile_record(ProfileStage stage, std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end, long long id) {
+    if (enabled) {
+        histograms[stage].record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    if (tracing) {
+        TraceSpan span = {stage, traceLane, id, start, end};
+        std::lock_guard<std::mutex> lock(spansMutex);
+        spans[nextSpan] = span;
+        if (++nextSpan == spans.size()) {
+            nextSpan = 0;
+            spansWrapped = true;
+        }
+    }
+}
+
+int set_trace_lane(int lane) {
+    int previous = traceLane;
+    traceLane = lane;
+    return previous;
+}
+
+// microseconds since the start of the trace
+static double trace_time(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - traceStart).count();
+}
+
+static void write_lane_name(FILE *f, int lane, const char *name) {
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n",
+            lane, name);
+}
+
+void write_trace() {
+    if (!tracing) {
+        return;
+    }
+    FILE *f = fopen(traceFile.c_str(), "w");
+    if (f == NULL) {
+        std::cerr << "Cannot write the trace file " << traceFile << "." << std::endl;
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(spansMutex);
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    write_lane_name(f, TRACE_LANE_MAIN, "main");
+    write_lane_name(f, TRACE_LANE_SENDER, "osc sender");
+    write_lane_name(f, TRACE_LANE_CAMERA, "camera 1");
+    write_lane_name(f, TRACE_LANE_CAMERA + 1, "camera 2");
+    
+    // oldest spans first
+    std::size_t first = spansWrapped ? nextSpan : 0;
+    std::size_t n = spansWrapped ? spans.size() : nextSpan;
+    for (std::size_t i = 0; i < n; i++) {
+        const TraceSpan &s = spans[(first + i) % spans.size()];
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                STAGE_NAMES[s.stage], s.lane, trace_time(s.start), trace_time(s.end) - trace_time(s.start));
+        if (s.id >= 0) {
+            fprintf(f, ",\"args\":{\"id\":%lld}", s.id);
+        }
+        fprintf(f, "},\n");
+    }
+    // the process name closes the list, so no event is followed by a dangling comma
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"balloon tracker\"}}\n]}\n");
+    fclose(f);
+}
+
+void profile_report_if_due() {
+    if (!enabled) {
+        return;
+    }
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - lastReport < reportInterval) {
+        return;
+    }
+    profile_report();
+}
+
+void profile_report() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - lastReport).count();
+    lastReport = now;
+    
+    // formatted on a stream of its own, so the flags of std::cout stay untouched
+    std::ostringstream report;
+    report << std::fixed << std::left << std::setw(14) << "stage" << std::right << " " << std::setw(8) << "count"
+            << " " << std::setw(10) << "p50" << " " << std::setw(10) << "p99" << " " << std::setw(10) << "max"
+            << std::setprecision(1) << "   (last " << seconds << " s, times in ms)" << std::endl;
+    report << std::setprecision(3);
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        LatencyHistogram &h = histograms[i];
+        if (h.count() == 0) {
+            continue;
+        }
+        report << std::left << std::setw(14) << STAGE_NAMES[i] << std::right << " " << std::setw(8) << h.count()
+                << " " << std::setw(10) << h.percentile(50) / 1e6 << " " << std::setw(10) << h.percentile(99) / 1e6
+                << " " << std::setw(10) << h.max() / 1e6 << std::endl;
+        h.reset();
+    }
+    std::cout << report.str() << std::flush;
+}
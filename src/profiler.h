@@ -0,0 +1,188 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "config_parser.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+/**
+ * Stages of the tracking pipeline that are timed.
+ */
+enum ProfileStage {
+    STAGE_FRAME,          // whole iteration of the main loop
+    STAGE_CAPTURE,        // reading the frame from the camera or file
+    STAGE_REMAP,          // undistortion and rectification
+    STAGE_RESIZE,
+    STAGE_PREDICT,        // filter prediction and inspect regions
+    STAGE_FILTER_PREDICT, // prediction of a single filter
+    STAGE_MOG2,           // background subtraction
+    STAGE_MORPHOLOGY,     // mask thresholding and opening
+    STAGE_DETECTION,      // Hough or blob circle detection
+    STAGE_MATCHING,       // assignment of the circles to the filters
+    STAGE_CORRECT,        // filter correction
+    STAGE_FILTER_CORRECT, // correction of a single filter
+    STAGE_TRIANGULATION,  // stereo position and Kalman filtering
+    STAGE_OSC_SEND,       // handing the frame to the sender
+    STAGE_OSC_TRANSMIT,   // serialization and transmission in the sender
+    STAGE_COUNT
+};
+
+/**
+ * Latency histogram with log-linear buckets: every power of two of
+ * nanoseconds is split into 2^SUB_BITS linear sub-buckets, so the relative
+ * error of the reported percentiles is below 1/2^SUB_BITS at any scale.
+ * Recording is a few relaxed atomic increments and can be done from any
+ * thread.
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+private:
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maximum;
+    
+    static int bucket_of(uint64_t ns);
+    static uint64_t bucket_top(int bucket);
+public:
+    LatencyHistogram();
+    
+    /**
+     * @param ns Measured duration in nanoseconds.
+     */
+    void record(uint64_t ns);
+    
+    /**
+     * @param p Percentile, from 0 to 100.
+     * @return Upper bound of the bucket holding the percentile, in nanoseconds.
+     */
+    uint64_t percentile(double p) const;
+    
+    uint64_t count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+    
+    uint64_t max() const {
+        return maximum.load(std::memory_order_relaxed);
+    }
+    
+    void reset();
+};
+
+// trace lanes, shown as threads by the trace viewer
+#define TRACE_LANE_MAIN 0
+#define TRACE_LANE_SENDER 1
+#define TRACE_LANE_CAMERA 2 // camera i is on lane TRACE_LANE_CAMERA + i
+
+/*
+ * Reads profile (0 or 1) and profileReportInterval (seconds) from the configuration.
+ * If traceFile is set, the stages are also recorded as spans in a ring buffer of the
+ * last traceBufferSize spans, which write_trace saves in the Chrome trace format
+ * (chrome://tracing, Perfetto).
+ * While both are disabled the timers don't read the clock.
+*/
+void init_profiler(ConfigParser config);
+
+/*
+ * True if the timers are measuring, for the histograms or for the trace.
+*/
+bool profiling_enabled();
+
+/*
+ * Records a stage that ran from start to end. The id is shown with its trace
+ * span, -1 if there is none.
+*/
+void profile_record(ProfileStage stage, std::chrono::steady_clock::time_point start,
+        std::chrono::steady_clock::time_point end, long long id);
+
+/*
+ * Sets the trace lane of the spans recorded by the calling thread.
+ * @return The previous lane.
+*/
+int set_trace_lane(int lane);
+
+/*
+ * Writes the recorded spans to traceFile, if tracing is enabled.
+*/
+void write_trace();
+
+/*
+ * Prints p50, p99 and max of every stage measured since the previous report
+ * and starts new histograms.
+*/
+void profile_report();
+
+/*
+ * Calls profile_report if profiling is enabled and the report interval has passed.
+*/
+void profile_report_if_due();
+
+/*
+ * Discards everything measured so far.
+*/
+void profile_reset();
+
+/**
+ * Records the time from its construction to the end of the scope.
+ */
+class ScopedTimer {
+    ProfileStage stage;
+    long long id;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+public:
+    ScopedTimer(ProfileStage s, long long ID = -1) : stage(s), id(ID), active(profiling_enabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    
+    ~ScopedTimer() {
+        stop();
+    }
+    
+    /**
+     * Records the time now instead of at the end of the scope.
+     */
+    void stop() {
+        if (active) {
+            profile_record(stage, start, std::chrono::steady_clock::now(), id);
+            active = false;
+        }
+    }
+    
+    /**
+     * Drops the measurement, nothing is recorded.
+     */
+    void discard() {
+        active = false;
+    }
+};
+
+/**
+ * Moves the spans of the calling thread to another trace lane until the end of the scope.
+ */
+class TraceLane {
+    int previous;
+public:
+    TraceLane(int lane) : previous(set_trace_lane(lane)) {}
+    
+    ~TraceLane() {
+        set_trace_lane(previous);
+    }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// times the rest of the enclosing scope
+#define PROFILE_SCOPE(stage) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(stage)
+
+// same, with an id shown in the trace
+#define PROFILE_SCOPE_ID(stage, id) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(stage, id)
+
+#endif
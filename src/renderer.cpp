@@ -0,0 +1,115 @@
+#include "renderer.h"
+
+#include "opencv2/highgui/highgui.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#define ESC 27
+
+Renderer::Renderer(ConfigParser config) : running(false), exit(false) {
+    double rate = config.getDouble("renderRate", 30);
+    delay = rate > 0 ? std::max(1, (int)(1000 / rate)) : 1;
+}
+
+Renderer::~Renderer() {
+    stop();
+    for (int i = 0; i < plots.size(); i++) {
+        delete plots[i].pending;
+    }
+}
+
+int Renderer::addWindow(MyWindow *window, int w, int h) {
+    WindowSlot slot;
+    slot.window = window;
+    slot.width = w;
+    slot.height = h;
+    slot.fresh = false;
+    windows.push_back(slot);
+    return windows.size() - 1;
+}
+
+int Renderer::addPlot(BalloonPlot *plot, int points) {
+    PlotSlot slot;
+    slot.plot = plot;
+    slot.pending = new RingBuffer<cv::Point3d>(points);
+    plots.push_back(slot);
+    drained.reserve(points);
+    return plots.size() - 1;
+}
+
+void Renderer::start() {
+    running = true;
+    renderThread = std::thread(&Renderer::run, this);
+}
+
+void Renderer::stop() {
+    if (running) {
+        running = false;
+        renderThread.join();
+    }
+}
+
+void Renderer::submitFrame(int window, cv::Mat *frame) {
+    if (frame == NULL) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    // the caller gets either a dropped frame or one the rendering thread has shown, after
+    // the first frames the same buffers go around and nothing is reallocated
+    std::swap(windows[window].latest, *frame);
+    windows[window].fresh = true;
+}
+
+void Renderer::submitPosition(int plot, double x, double y, double z) {
+    std::lock_guard<std::mutex> lock(mutex);
+    plots[plot].pending->push(cv::Point3d(x, y, z));
+}
+
+void Renderer::run() {
+    // the windows belong to this thread, HighGUI is not used anywhere else
+    for (int i = 0; i < windows.size(); i++) {
+        windows[i].window->init(windows[i].width, windows[i].height);
+    }
+    
+    while (running) {
+        std::chrono::steady_clock::time_point passStart = std::chrono::steady_clock::now();
+        
+        for (int i = 0; i < windows.size(); i++) {
+            WindowSlot &slot = windows[i];
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!slot.fresh) {
+                    continue;
+                }
+                // the headers are swapped, so the tracking thread gets the old buffer to write into
+                std::swap(slot.latest, slot.showing);
+                slot.fresh = false;
+            }
+            slot.window->showImage(slot.showing);
+        }
+        
+        for (int i = 0; i < plots.size(); i++) {
+            drained.clear();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                RingBuffer<cv::Point3d> &pending = *plots[i].pending;
+                for (int j = 0; j < pending.size(); j++) {
+                    drained.push_back(pending[j]);
+                }
+                pending.clear();
+            }
+            for (int j = 0; j < drained.size(); j++) {
+                plots[i].plot->add(drained[j].x, drained[j].y, drained[j].z);
+            }
+            plots[i].plot->refresh();
+        }
+        
+        // waitKey also processes the window events and sleeps until the next pass
+        int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - passStart).count();
+        if (cv::waitKey(std::max(1, delay - elapsed)) == ESC) {
+            exit = true;
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "config_parser.h"
+#include "plot.h"
+#include "ring_buffer.h"
+#include "window_manager.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Shows the camera windows and the balloon plots from a separate thread, so
+ * a slow X server or gnuplot process doesn't hold up the tracking loop. The
+ * tracking loop only hands over snapshots: for every window just the latest
+ * frame is kept and older ones are dropped, the balloon positions are queued
+ * (up to the plot history length) and passed to the plots at the next pass.
+ * The thread redraws at most renderRate times per second and also handles
+ * the keyboard, ESC requests the program to exit. The frames are handed over
+ * by swapping buffers, so nothing is copied.
+ */
+class Renderer {
+    struct WindowSlot {
+        MyWindow *window;
+        int width;
+        int height;
+        cv::Mat latest; // written by the tracking thread
+        cv::Mat showing; // owned by the rendering thread
+        bool fresh;
+    };
+    
+    struct PlotSlot {
+        BalloonPlot *plot;
+        RingBuffer<cv::Point3d> *pending;
+    };
+    
+    std::vector<WindowSlot> windows;
+    std::vector<PlotSlot> plots;
+    std::vector<cv::Point3d> drained;
+    
+    int delay; // ms between the passes
+    
+    std::thread renderThread;
+    std::mutex mutex;
+    std::atomic<bool> running;
+    std::atomic<bool> exit;
+    
+    void run();
+public:
+    Renderer(ConfigParser config);
+    ~Renderer();
+    
+    /**
+     * Registers a window, needs to be called before start.
+     * @param window Window, it is initialized from the rendering thread.
+     * @param w Width of the frames.
+     * @param h Height of the frames.
+     * @return Index of the window.
+     */
+    int addWindow(MyWindow *window, int w, int h);
+    
+    /**
+     * Registers the plot of a balloon, needs to be called before start.
+     * @param plot Plot, it is only updated from the rendering thread.
+     * @param points Number of positions that can be queued for the plot.
+     * @return Index of the plot.
+     */
+    int addPlot(BalloonPlot *plot, int points);
+    
+    /**
+     * Starts the rendering thread.
+     */
+    void start();
+    
+    /**
+     * Stops the rendering thread, after that the plots are not used anymore.
+     */
+    void stop();
+    
+    /**
+     * Replaces the frame waiting to be shown in the window.
+     * @param window Window index.
+     * @param frame Frame, it is swapped with a buffer that isn't shown anymore
+     * and can be drawn into again, nothing is done if it is NULL.
+     */
+    void submitFrame(int window, cv::Mat *frame);
+    
+    /**
+     * Queues a balloon position for the plot.
+     * @param plot Plot index.
+     * @param x X coordinate.
+     * @param y Y coordinate.
+     * @param z Z coordinate.
+     */
+    void submitPosition(int plot, double x, double y, double z);
+    
+    /**
+     * @return True if ESC was pressed in one of the windows.
+     */
+    bool exitRequested() {
+        return exit;
+    }
+};
+
+#endif
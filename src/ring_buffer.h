@@ -0,0 +1,73 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Fixed-capacity history of the most recent values. Adding a value to a full
+ * buffer overwrites the oldest one, so every push is O(1) and nothing is
+ * moved or reallocated after construction. Values are indexed from the oldest
+ * (0) to the newest (size() - 1), which lets the buffer be passed wherever a
+ * vector is only read through size() and operator[].
+ */
+template<class T>
+class RingBuffer {
+    std::vector<T> data;
+    size_t start;
+    size_t count;
+public:
+    /**
+     * @param capacity Maximal number of stored values.
+     */
+    RingBuffer(size_t capacity) : data(capacity > 0 ? capacity : 1), start(0), count(0) {}
+    
+    /**
+     * Appends the value, discarding the oldest one if the buffer is full.
+     * @param value Value to store.
+     */
+    void push(const T &value) {
+        size_t end = start + count;
+        if (end >= data.size()) {
+            end -= data.size();
+        }
+        data[end] = value;
+        if (count < data.size()) {
+            count++;
+        } else if (++start == data.size()) {
+            start = 0;
+        }
+    }
+    
+    /**
+     * @param i Index, 0 is the oldest value.
+     * @return Reference to the stored value.
+     */
+    const T& operator[](size_t i) const {
+        size_t j = start + i;
+        return data[j < data.size() ? j : j - data.size()];
+    }
+    
+    const T& newest() const {
+        return (*this)[count - 1];
+    }
+    
+    size_t size() const {
+        return count;
+    }
+    
+    size_t capacity() const {
+        return data.size();
+    }
+    
+    bool empty() const {
+        return count == 0;
+    }
+    
+    void clear() {
+        start = 0;
+        count = 0;
+    }
+};
+
+#endif
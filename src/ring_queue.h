@@ -0,0 +1,128 @@
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * Bounded lock-free queue based on a ring of slots with sequence numbers.
+ * It is meant for one producer and one consumer thread; the producer may
+ * additionally discard the oldest entries when the queue is full, which is
+ * safe because every slot is claimed before it is read or written.
+ * The slots are allocated once, so the stored objects keep their capacity
+ * (e.g. of contained vectors) between uses.
+ */
+template<class T>
+class RingQueue {
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+    
+    Slot *slots;
+    size_t mask;
+    
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    
+    // used only by the producer when discarding entries
+    T discarded;
+    
+    RingQueue(const RingQueue&);
+    RingQueue& operator=(const RingQueue&);
+public:
+    /**
+     * @param capacity Minimal number of entries, rounded up to a power of two.
+     */
+    RingQueue(size_t capacity) : head(0), tail(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        slots = new Slot[size];
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    ~RingQueue() {
+        delete[] slots;
+    }
+    
+    /**
+     * Adds an entry to the queue.
+     * @return False if the queue is full.
+     */
+    bool push(const T &item) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->data = item;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * Takes the oldest entry from the queue.
+     * @return False if the queue is empty.
+     */
+    bool pop(T &item) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        item = slot->data;
+        slot->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * Adds an entry to the queue, discarding the oldest entries if it's full.
+     * Must be called only from the producer thread.
+     * @return Number of entries that were dropped, including the new one
+     *          if the consumer holds the only free slot.
+     */
+    size_t pushDropOldest(const T &item) {
+        size_t dropped = 0;
+        while (!push(item)) {
+            if (!pop(discarded)) {
+                return dropped + 1;
+            }
+            dropped++;
+        }
+        return dropped;
+    }
+    
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif
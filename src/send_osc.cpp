@@ -1,30 +1,353 @@
-#include "send_osc.h"
-
-#include <iostream>
-#include <cstdio>
-
-#define OUTPUT_BUFFER_SIZE 1024
-
-MyOSCSender::MyOSCSender(ConfigParser config) {
-    const char* address = config.getString("oscAddress");
-    int port = config.getInt("oscPort");
-    transmitSocket = new UdpTransmitSocket(IpEndpointName(address, port));
-}
-
-void MyOSCSender::sendPosition(int ball, double x, double y, double z) {
-    char buffer[OUTPUT_BUFFER_SIZE];
-    osc::OutboundPacketStream p(buffer, OUTPUT_BUFFER_SIZE);
-
-    char sx[10], sy[10], sz[10];
-    sprintf(sx, "/ball%d/x", ball);
-    sprintf(sy, "/ball%d/y", ball);
-    sprintf(sz, "/ball%d/z", ball);
-
-    p << osc::BeginBundleImmediate
-            << osc::BeginMessage(sx) << x << osc::EndMessage
-            << osc::BeginMessage(sy) << y << osc::EndMessage
-            << osc::BeginMessage(sz) << z << osc::EndMessage
-      << osc::EndBundle;
-
-    transmitSocket->Send(p.Data(), p.Size());
-}
+#include "send_osc.h"
+
+#include "profiler.h"
+
+#include "osc/OscHostEndianness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#define OUTPUT_BUFFER_SIZE 1024
+// upper bound for the size of the /ballN/x, /ballN/y and /ballN/z messages of one balloon
+#define BALLOON_MESSAGES_SIZE 128
+// bounds of the number of queued frames
+#define MIN_QUEUE_SIZE 2
+#define MAX_QUEUE_SIZE 65536
+
+static const char AXES[3] = {'x', 'y', 'z'};
+
+// writes the double in the big endian byte order used by OSC
+static void write_double(char *p, double value) {
+    char c[8];
+    std::memcpy(c, &value, 8);
+#ifdef OSC_HOST_LITTLE_ENDIAN
+    for (int i = 0; i < 8; i++) {
+        p[i] = c[7 - i];
+    }
+#else
+    std::memcpy(p, c, 8);
+#endif
+}
+
+static void write_uint16(char *p, osc::uint32 value) {
+    p[0] = (char)(value >> 8);
+    p[1] = (char)value;
+}
+
+static void write_uint32(char *p, osc::uint32 value) {
+    p[0] = (char)(value >> 24);
+    p[1] = (char)(value >> 16);
+    p[2] = (char)(value >> 8);
+    p[3] = (char)value;
+}
+
+static void write_uint64(char *p, osc::uint64 value) {
+    write_uint32(p, (osc::uint32)(value >> 32));
+    write_uint32(p + 4, (osc::uint32)value);
+}
+
+static void write_float(char *p, double value) {
+    float f = (float)value;
+    osc::uint32 u;
+    std::memcpy(&u, &f, 4);
+    write_uint32(p, u);
+}
+
+// seconds between the NTP epoch (1900) and the Unix epoch (1970)
+#define NTP_UNIX_OFFSET 2208988800ULL
+
+// converts the time to the 64 bit NTP format used by OSC timetags,
+// seconds in the upper 32 bits and the fraction of a second in the lower 32 bits
+static osc::uint64 to_ntp_time(std::chrono::system_clock::time_point time) {
+    long long us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    osc::uint64 seconds = (osc::uint64)(us / 1000000) + NTP_UNIX_OFFSET;
+    osc::uint64 fraction = ((osc::uint64)(us % 1000000) << 32) / 1000000;
+    return (seconds << 32) | fraction;
+}
+
+// parses the port of a destination, returns 0 if it isn't a number from 1 to 65535
+static int parse_port(const std::string &s) {
+    const char *begin = s.c_str();
+    char *end;
+    long port = strtol(begin, &end, 10);
+    if (end == begin || *end != '\0' || port < 1 || port > 65535) {
+        return 0;
+    }
+    return (int) port;
+}
+
+// resolves the host of a destination, returns false if it has no address to send to
+static bool add_destination(const std::string &host, int port, std::vector<IpEndpointName> &result) {
+    IpEndpointName destination(host.c_str(), port);
+    if (destination.address == 0) {
+        std::cerr << "OSC destination host \"" << host << "\" cannot be resolved." << std::endl;
+        return false;
+    }
+    result.push_back(destination);
+    return true;
+}
+
+// parses a comma separated list of host:port pairs, returns false if any of them is malformed
+// or its host cannot be resolved
+static bool parse_destinations(const char *list, std::vector<IpEndpointName> &result) {
+    std::stringstream ss(list);
+    std::string item;
+    while (getline(ss, item, ',')) {
+        std::size_t b = item.find_first_not_of(" \t");
+        std::size_t e = item.find_last_not_of(" \t");
+        if (b == std::string::npos) {
+            continue;
+        }
+        item = item.substr(b, e - b + 1);
+        std::size_t colon = item.rfind(':');
+        if (colon == std::string::npos || colon == 0) {
+            std::cerr << "OSC destination \"" << item << "\" needs to be in the host:port format." << std::endl;
+            return false;
+        }
+        int port = parse_port(item.substr(colon + 1));
+        if (port == 0) {
+            std::cerr << "OSC destination \"" << item << "\" needs a port from 1 to 65535." << std::endl;
+            return false;
+        }
+        if (!add_destination(item.substr(0, colon), port, result)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MyOSCSender::MyOSCSender(ConfigParser config) : running(false), dropped(0) {
+    valid = true;
+    const char* list = config.getString("oscDestinations", NULL);
+    if (list != NULL) {
+        valid = parse_destinations(list, destinations);
+    } else {
+        const char* address = config.getString("oscAddress");
+        int port = config.getInt("oscPort");
+        if (port < 1 || port > 65535) {
+            std::cerr << "oscPort needs to be from 1 to 65535." << std::endl;
+            valid = false;
+        } else {
+            valid = address != NULL && add_destination(address, port, destinations);
+        }
+    }
+    nOscDestinations = destinations.size();
+    
+    const char* binaryList = config.getString("binaryDestinations", NULL);
+    if (binaryList != NULL) {
+        valid = parse_destinations(binaryList, destinations) && valid;
+    }
+    if (valid && destinations.empty()) {
+        std::cerr << "No OSC or binary destinations are given." << std::endl;
+        valid = false;
+    }
+    
+    socket = new UdpSocket();
+    datagramData.reserve(destinations.size());
+    datagramSizes.reserve(destinations.size());
+    
+    int nBalloons = config.getInt("nBalloons");
+    std::size_t frameSize = OUTPUT_BUFFER_SIZE + nBalloons * BALLOON_MESSAGES_SIZE;
+    frameBuffer = new char[frameSize];
+    frame = new osc::OutboundPacketStream(frameBuffer, frameSize);
+    current.positions.reserve(nBalloons);
+    current.frameId = 0;
+    current.captureTime = 0;
+    current.timeTag = 1;
+    frameCount = 0;
+    binaryFrame.resize(BINARY_HEADER_SIZE + nBalloons * BINARY_BALLOON_SIZE);
+    
+    timeTags = config.getInt("oscTimeTags", 0) != 0;
+    timeTagOffset = std::chrono::microseconds((long long)(config.getDouble("oscTimeTagOffset", 0.0) * 1000));
+    
+    // the messages differ between frames only in the coordinates, so they are serialized once
+    templates.resize(nBalloons);
+    for (int i = 0; i < nBalloons; i++) {
+        for (int a = 0; a < 3; a++) {
+            char address[32];
+            snprintf(address, sizeof(address), "/ball%d/%c", i, AXES[a]);
+            char buffer[OUTPUT_BUFFER_SIZE];
+            osc::OutboundPacketStream p(buffer, OUTPUT_BUFFER_SIZE);
+            p << osc::BeginMessage(address) << 0.0 << osc::EndMessage;
+            templates[i].messages[a].assign(p.Data(), p.Data() + p.Size());
+        }
+    }
+    
+    async = config.getInt("oscAsync", 1) != 0;
+    queue = NULL;
+    if (async) {
+        int queueSize = config.getInt("oscQueueSize", 64);
+        int bounded = std::min(std::max(queueSize, MIN_QUEUE_SIZE), MAX_QUEUE_SIZE);
+        if (bounded != queueSize) {
+            std::cerr << "oscQueueSize needs to be between " << MIN_QUEUE_SIZE << " and " << MAX_QUEUE_SIZE
+                    << ", using " << bounded << "." << std::endl;
+        }
+        queue = new RingQueue<PositionFrame>(bounded);
+        running = true;
+        senderThread = std::thread(&MyOSCSender::run, this);
+    }
+}
+
+MyOSCSender::~MyOSCSender() {
+    if (async) {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            running = false;
+            wake.notify_one();
+        }
+        senderThread.join();
+        if (dropped > 0) {
+            std::cerr << "OSC sender dropped " << dropped << " frames." << std::endl;
+        }
+        delete queue;
+    }
+    delete frame;
+    delete[] frameBuffer;
+    delete socket;
+}
+
+bool MyOSCSender::isValid() const {
+    return valid;
+}
+
+void MyOSCSender::writePosition(osc::OutboundPacketStream &p, int ball, double x, double y, double z) {
+    double values[3] = {x, y, z};
+    
+    if (ball >= 0 && ball < templates.size()) {
+        for (int a = 0; a < 3; a++) {
+            const std::vector<char> &m = templates[ball].messages[a];
+            char *message = p.AppendPreformattedMessage(&m[0], m.size());
+            write_double(message + m.size() - 8, values[a]);
+        }
+        return;
+    }
+    
+    for (int a = 0; a < 3; a++) {
+        char address[32];
+        snprintf(address, sizeof(address), "/ball%d/%c", ball, AXES[a]);
+        p << osc::BeginMessage(address) << values[a] << osc::EndMessage;
+    }
+}
+
+std::size_t MyOSCSender::writeBinaryFrame(const PositionFrame &positions) {
+    std::size_t size = BINARY_HEADER_SIZE + positions.positions.size() * BINARY_BALLOON_SIZE;
+    if (binaryFrame.size() < size) {
+        binaryFrame.resize(size);
+    }
+    
+    char *p = &binaryFrame[0];
+    write_uint32(p, BINARY_MAGIC);
+    write_uint16(p + 4, BINARY_VERSION);
+    write_uint16(p + 6, positions.positions.size());
+    write_uint32(p + 8, positions.frameId);
+    write_uint64(p + 12, positions.captureTime);
+    p += BINARY_HEADER_SIZE;
+    
+    for (int i = 0; i < positions.positions.size(); i++, p += BINARY_BALLOON_SIZE) {
+        const BalloonPosition &b = positions.positions[i];
+        write_uint32(p, b.ball);
+        write_float(p + 4, b.x);
+        write_float(p + 8, b.y);
+        write_float(p + 12, b.z);
+        write_float(p + 16, b.confidence);
+    }
+    
+    return size;
+}
+
+void MyOSCSender::sendPosition(int ball, double x, double y, double z) {
+    char buffer[OUTPUT_BUFFER_SIZE];
+    osc::OutboundPacketStream p(buffer, OUTPUT_BUFFER_SIZE);
+
+    p << osc::BeginBundleImmediate;
+    writePosition(p, ball, x, y, z);
+    p << osc::EndBundle;
+
+    for (int i = 0; i < nOscDestinations; i++) {
+        socket->SendTo(destinations[i], p.Data(), p.Size());
+    }
+}
+
+void MyOSCSender::transmitFrame(const PositionFrame &positions) {
+    PROFILE_SCOPE_ID(STAGE_OSC_TRANSMIT, positions.frameId);
+    
+    frame->Clear();
+    *frame << osc::BeginBundle(positions.timeTag);
+    for (int i = 0; i < positions.positions.size(); i++) {
+        const BalloonPosition &b = positions.positions[i];
+        writePosition(*frame, b.ball, b.x, b.y, b.z);
+    }
+    *frame << osc::EndBundle;
+    
+    if (destinations.empty()) {
+        return;
+    }
+    
+    // the same packet goes to every destination of its kind, all are flushed with a single call
+    datagramData.assign(nOscDestinations, frame->Data());
+    datagramSizes.assign(nOscDestinations, frame->Size());
+    if (destinations.size() > nOscDestinations) {
+        std::size_t binarySize = writeBinaryFrame(positions);
+        datagramData.resize(destinations.size(), &binaryFrame[0]);
+        datagramSizes.resize(destinations.size(), binarySize);
+    }
+    socket->SendToMultiple(&destinations[0], &datagramData[0], &datagramSizes[0], destinations.size());
+}
+
+// sender thread, serializes and transmits the queued frames and sleeps while there are none
+void MyOSCSender::run() {
+    PositionFrame pending;
+    pending.positions.reserve(current.positions.capacity());
+    pending.frameId = 0;
+    pending.captureTime = 0;
+    pending.timeTag = 1;
+    set_trace_lane(TRACE_LANE_SENDER);
+    
+    while (true) {
+        if (queue->pop(pending)) {
+            transmitFrame(pending);
+            continue;
+        }
+        if (!running) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (queue->empty() && running) {
+            wake.wait(lock);
+        }
+    }
+}
+
+void MyOSCSender::beginFrame(std::chrono::system_clock::time_point captureTime) {
+    current.positions.clear();
+    current.frameId = frameCount++;
+    current.captureTime = to_ntp_time(captureTime);
+    current.timeTag = timeTags ? to_ntp_time(captureTime + timeTagOffset) : 1;
+}
+
+void MyOSCSender::beginFrame() {
+    beginFrame(std::chrono::system_clock::now());
+}
+
+void MyOSCSender::addPosition(int ball, double x, double y, double z, double confidence) {
+    BalloonPosition b = {ball, x, y, z, confidence};
+    current.positions.push_back(b);
+}
+
+void MyOSCSender::sendFrame() {
+    if (!async) {
+        transmitFrame(current);
+        return;
+    }
+    
+    dropped += queue->pushDropOldest(current);
+    // notifying under the lock, so the frame can't slip in between the sender's check and its wait
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    wake.notify_one();
+}
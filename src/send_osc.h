@@ -1,24 +1,162 @@
-/* 
- * File:   send_osc.h
- * Author: Karlo
- *
- * Created on November 23, 2015, 4:30 PM
- */
-
-#ifndef SEND_OSC_H
-#define	SEND_OSC_H
-
-#include "config_parser.h"
-
-#include "osc/OscOutboundPacketStream.h"
-#include "ip/UdpSocket.h"
-
-class MyOSCSender {
-    UdpTransmitSocket *transmitSocket;
-public:
-    MyOSCSender(ConfigParser config);
-    void sendPosition(int ball, double x, double y, double z);
-};
-
-#endif	/* SEND_OSC_H */
-
+/* 
+ * File:   send_osc.h
+ * Author: Karlo
+ *
+ * Created on November 23, 2015, 4:30 PM
+ */
+
+#ifndef SEND_OSC_H
+#define	SEND_OSC_H
+
+#include "config_parser.h"
+#include "ring_queue.h"
+
+#include "osc/OscOutboundPacketStream.h"
+#include "ip/UdpSocket.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Position of a single balloon.
+ */
+struct BalloonPosition {
+    int ball;
+    double x;
+    double y;
+    double z;
+    double confidence;
+};
+
+/**
+ * Positions of all balloons from one frame.
+ */
+struct PositionFrame {
+    std::vector<BalloonPosition> positions;
+    osc::uint32 frameId;
+    osc::uint64 captureTime; // NTP format
+    osc::uint64 timeTag; // 1 means immediately
+};
+
+/*
+ * Compact binary position packet, all fields in network byte order:
+ *   header   uint32 magic, uint16 version, uint16 balloon count,
+ *            uint32 frame id, uint64 capture time (NTP format)
+ *   balloon  uint32 id, float32 x, y, z, float32 confidence (0 to 1)
+ */
+#define BINARY_MAGIC 0x424C4E53 // "BLNS"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 20
+#define BINARY_BALLOON_SIZE 20
+
+/**
+ * Serialized /ballN/x, /ballN/y and /ballN/z messages of one balloon. The
+ * coordinate is the last 8 bytes of each message and is patched before sending.
+ */
+struct PositionTemplate {
+    std::vector<char> messages[3];
+};
+
+/**
+ * Class which sends the balloon positions over OSC to one or more destinations,
+ * given as a comma separated list of host:port pairs in oscDestinations (or by
+ * oscAddress and oscPort). All datagrams of a frame are flushed together. By default the frames are
+ * handed to a dedicated sender thread through a lock-free queue, so the tracking
+ * loop never waits for the network; the thread sleeps while the queue is empty.
+ * If the receiver can't keep up, the oldest queued frames (at most oscQueueSize,
+ * from 2 to 65536) are dropped.
+ * If oscTimeTags is set, each bundle carries the NTP time at which its frame was
+ * captured, moved oscTimeTagOffset milliseconds into the future, so receivers can
+ * compensate for the latency or schedule the playback. Otherwise the bundles are
+ * marked to be processed immediately.
+ * Frames can also be sent as compact binary packets to the destinations listed
+ * in binaryDestinations, in the same batch as the OSC bundles.
+ */
+class MyOSCSender {
+    UdpSocket *socket;
+    bool valid;
+    std::vector<IpEndpointName> destinations; // OSC destinations first, then the binary ones
+    int nOscDestinations;
+    
+    // datagrams of the current frame, one per destination
+    std::vector<const char*> datagramData;
+    std::vector<std::size_t> datagramSizes;
+    
+    char *frameBuffer;
+    osc::OutboundPacketStream *frame;
+    std::vector<char> binaryFrame;
+    
+    PositionFrame current;
+    osc::uint32 frameCount;
+    std::vector<PositionTemplate> templates;
+    
+    bool timeTags;
+    std::chrono::microseconds timeTagOffset;
+    
+    bool async;
+    RingQueue<PositionFrame> *queue;
+    std::thread senderThread;
+    std::atomic<bool> running;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    unsigned long dropped;
+    
+    void writePosition(osc::OutboundPacketStream &p, int ball, double x, double y, double z);
+    std::size_t writeBinaryFrame(const PositionFrame &positions);
+    void transmitFrame(const PositionFrame &positions);
+    void run();
+public:
+    MyOSCSender(ConfigParser config);
+    ~MyOSCSender();
+    
+    /**
+     * @return False if a destination is malformed, its host cannot be resolved or
+     *          there are none, the reason is printed when the sender is created.
+     */
+    bool isValid() const;
+    
+    /**
+     * Sends the position of a single balloon in its own bundle.
+     * The position is sent immediately, from the calling thread.
+     * @param ball Balloon index.
+     * @param x X coordinate.
+     * @param y Y coordinate.
+     * @param z Z coordinate.
+     */
+    void sendPosition(int ball, double x, double y, double z);
+    
+    /**
+     * Starts a new frame. Positions added until sendFrame is called are sent
+     * together in a single bundle, so receivers get one datagram per frame.
+     * @param captureTime Time when the frame was captured, used for the bundle timetag.
+     */
+    void beginFrame(std::chrono::system_clock::time_point captureTime);
+    
+    /**
+     * Starts a new frame captured right now.
+     */
+    void beginFrame();
+    
+    /**
+     * Adds the position of a balloon to the current frame.
+     * @param ball Balloon index.
+     * @param x X coordinate.
+     * @param y Y coordinate.
+     * @param z Z coordinate.
+     * @param confidence Tracking confidence from 0 to 1, only sent in the binary packets.
+     */
+    void addPosition(int ball, double x, double y, double z, double confidence);
+    
+    /**
+     * Sends all positions added since beginFrame, or queues them for the
+     * sender thread.
+     */
+    void sendFrame();
+};
+
+#endif	/* SEND_OSC_H */
+
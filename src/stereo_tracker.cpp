@@ -0,0 +1,98 @@
+#include "stereo_tracker.h"
+#include "circles.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool StereoTracker::init(ConfigParser config) {
+    nBalloons = config.getInt("nBalloons");
+    
+    xAxisRatio = config.getDouble("xAxisRatio");
+    yAxisRatio = config.getDouble("yAxisRatio");
+    zAxisRatio = config.getDouble("zAxisRatio");
+    
+    init_circles(config);
+    
+    supKalmans.assign(nBalloons, SuperiorKalman(config));
+    positions.assign(nBalloons, cv::Point3f());
+    
+    tracker1.init(config);
+    tracker2.init(config);
+    
+    double sw = tracker1.getScaledWidth();
+    double sh = tracker1.getScaledHeight();
+    if (std::abs(tracker2.getScaledWidth()-sw) >= 1 || std::abs(tracker2.getScaledHeight()-sh) >= 1) {
+        std::cerr << "Video frames need to have the same size ratio." << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+void StereoTracker::configure(ConfigParser config) {
+    configure_circles(config);
+    tracker1.configure(config);
+    tracker2.configure(config);
+    for (int i = 0; i < supKalmans.size(); i++) {
+        supKalmans[i].configure(config);
+    }
+}
+
+int StereoTracker::next_frame() {
+    int t1 = tracker1.next_frame();
+    int t2 = tracker2.next_frame();
+    
+    if (t1 == -1 || t2 == -1) {
+        return -1;
+    }
+    
+    if (t1 || t2) {
+        return 1;
+    }
+    
+    triangulate();
+    return 0;
+}
+
+// combines the states of both cameras into the 3D positions and filters them
+void StereoTracker::triangulate() {
+    PROFILE_SCOPE(STAGE_TRIANGULATION);
+    
+    for (int i = 0; i < nBalloons; i++) {
+        cv::Point3f p = triangulatePoint(tracker1.getStateX(i), tracker1.getStateY(i),
+                tracker2.getStateX(i), tracker2.getStateY(i));
+
+        supKalmans[i].predict();
+        cv::Mat position = supKalmans[i].correct((cv::Mat_<float>(3,1) << p.x, p.y, p.z));
+        positions[i] = cv::Point3f(position.at<float>(0, 0), position.at<float>(1, 0), position.at<float>(2, 0));
+        
+        // std::cout << "p1 " << p << " p2 " << positions[i] << std::endl;
+    }
+}
+
+// position in the output coordinates from the points in both scaled rectified frames
+cv::Point3f StereoTracker::triangulatePoint(double x1, double y1, double x2, double y2) {
+    double xe1 = x1 * xAxisRatio;
+    double ye1 = y1 * yAxisRatio;
+    double xe2 = x2 * xAxisRatio;
+    double ye2 = y2 * yAxisRatio;
+
+    double U = xe1;
+    double V = (ye1 + ye2)/2;
+    if (xe2 == xe1) {
+        xe2 = xe1 + xAxisRatio;
+    }
+    double W = zAxisRatio / std::abs(xe2-xe1);
+    
+    return cv::Point3f(U, V, W);
+}
+
+double StereoTracker::getConfidence(int balloon) {
+    return std::min(tracker1.getConfidence(balloon), tracker2.getConfidence(balloon));
+}
+
+std::chrono::system_clock::time_point StereoTracker::getCaptureTime() {
+    return std::min(tracker1.getCaptureTime(), tracker2.getCaptureTime());
+}
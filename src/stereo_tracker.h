@@ -0,0 +1,97 @@
+#ifndef STEREO_TRACKER_H
+#define STEREO_TRACKER_H
+
+#include "config_parser.h"
+#include "superior_kalman.h"
+#include "video_tracker.h"
+
+#include "opencv2/core/core.hpp"
+
+#include <chrono>
+#include <vector>
+
+/**
+ * The whole tracking pipeline of the stereo pair: both VideoTrackers followed by
+ * the triangulation and the SuperiorKalman filter of every balloon. Shared by the
+ * tracker and the benchmark, the output of the positions is left to the caller.
+ */
+class StereoTracker {
+    int nBalloons;
+    
+    double xAxisRatio;
+    double yAxisRatio;
+    double zAxisRatio;
+    
+    VideoTracker tracker1;
+    VideoTracker tracker2;
+    std::vector<SuperiorKalman> supKalmans;
+    
+    std::vector<cv::Point3f> positions; // filtered positions from the last frame
+    
+    void triangulate();
+    cv::Point3f triangulatePoint(double x1, double y1, double x2, double y2);
+public:
+    StereoTracker() : tracker1(0), tracker2(1) {};
+    
+    /**
+     * Opens both videos and initializes the filters.
+     * @param config Configuration.
+     * @return False if the videos can't be used together.
+     */
+    bool init(ConfigParser config);
+    
+    /**
+     * Rereads the parameters that can be changed between frames without restarting.
+     * @param config Configuration with the new values.
+     */
+    void configure(ConfigParser config);
+    
+    /**
+     * Tracks the balloons in the next pair of frames.
+     * @return 0 on success, 1 at the end of a video, -1 if a frame can't be read.
+     */
+    int next_frame();
+    
+    int getBalloonCount() {
+        return nBalloons;
+    }
+    
+    /**
+     * @param balloon Balloon index.
+     * @return Position of the balloon after the last frame, in the output coordinates.
+     */
+    cv::Point3f getPosition(int balloon) {
+        return positions[balloon];
+    }
+    
+    /**
+     * @param balloon Balloon index.
+     * @return Tracking confidence from 0 to 1, the lower of the two cameras.
+     */
+    double getConfidence(int balloon);
+    
+    /**
+     * @return Capture time of the older of the two frames.
+     */
+    std::chrono::system_clock::time_point getCaptureTime();
+    
+    /**
+     * @param camera 0 or 1.
+     */
+    VideoTracker* getTracker(int camera) {
+        return camera == 0 ? &tracker1 : &tracker2;
+    }
+    
+    // extent of the tracked space in the output coordinates
+    double getWidth() {
+        return tracker1.getScaledWidth() * xAxisRatio;
+    }
+    double getHeight() {
+        return tracker1.getScaledHeight() * yAxisRatio;
+    }
+    double getDepth() {
+        return zAxisRatio / xAxisRatio;
+    }
+};
+
+#endif
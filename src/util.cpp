@@ -1,18 +1,20 @@
-#include "util.h"
-
-#include <cstring>
-#include <string>
-
-const char* concat(const char* pref, int id) {
-    std::string s = pref;
-    s += id+'0';
-    return s.c_str();
-}
-
-// checks if the given string is a number
-bool is_number(const char *ss) {
-    std::string s(ss, strlen(ss));
-    std::string::const_iterator it = s.begin();
-    while (it != s.end() && std::isdigit(*it)) ++it;
-    return !s.empty() && it == s.end();
+#include "util.h"
+
+#include <cstring>
+#include <string>
+
+// the result stays valid until the next call from the same thread
+const char* concat(const char* pref, int id) {
+    static thread_local std::string s;
+    s = pref;
+    s += std::to_string(id);
+    return s.c_str();
+}
+
+// checks if the given string is a number
+bool is_number(const char *ss) {
+    std::string s(ss, strlen(ss));
+    std::string::const_iterator it = s.begin();
+    while (it != s.end() && std::isdigit(*it)) ++it;
+    return !s.empty() && it == s.end();
 }
\ No newline at end of file
@@ -1,66 +1,118 @@
-#ifndef VIDEO_TRACKER
-#define VIDEO_TRACKER
-
-#include "condensation.h"
-#include "config_parser.h"
-#include "motion_detection.h"
-#include "window_manager.h"
-
-#include "opencv2/core/core.hpp"
-#include "opencv2/highgui/highgui.hpp"
-
-#include <vector>
-
-class VideoTracker {
-    int id;
-    
-    cv::VideoCapture *vid;
-    std::vector<Condensation*> filters;
-    
-    cv::Mat frame;
-    int fw;
-    int fh;
-    int frameCount;
-    int fps;
-    
-    double scaleFactor;
-    
-    cv::Mat ur_mapx, ur_mapy; // undistort rectify matrices
-    
-    cv::Mat *estimatedStates;
-    
-    MotionDetector *md;
-    
-    MyWindow *window;
-public:
-    VideoTracker(int ID) : id(ID) {
-        md = new MotionDetector(ID);
-    };
-    void init(ConfigParser config);
-    int next_frame();
-    ~VideoTracker() {
-        delete vid;
-        delete estimatedStates;
-        delete md;
-        for (int i = 0; i < filters.size(); i++) {
-            delete filters[i];
-        }
-    }
-    double getScaledWidth() {
-        return scaleFactor * fw;
-    }
-    double getScaledHeight() {
-        return scaleFactor * fh;
-    }
-    cv::Mat getFrame() {
-        return frame.clone();
-    }
-    double getStateX(int balloon) {
-        return estimatedStates[balloon].at<float>(0);
-    }
-    double getStateY(int balloon) {
-        return estimatedStates[balloon].at<float>(1);
-    }
-};
-
+#ifndef VIDEO_TRACKER
+#define VIDEO_TRACKER
+
+#include "circles.h"
+#include "condensation.h"
+#include "config_parser.h"
+#include "motion_detection.h"
+#include "window_manager.h"
+
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp"
+
+#include <chrono>
+#include <vector>
+
+class VideoTracker {
+    int id;
+    
+    cv::VideoCapture *vid;
+    std::vector<Condensation*> filters;
+    
+    cv::Mat frame; // view into the inner part of framePadded
+    cv::Mat framePadded; // scaled frame with a BORDER_THICKNESS margin
+    cv::Mat frameRaw;
+    cv::Mat frameRectified;
+    cv::Mat frameVisual; // image that will be displayed, empty in the headless mode
+    bool drawing; // the current frame is drawn into frameVisual
+    int decimation; // only every decimation-th frame is drawn
+    long long frameNumber;
+    std::chrono::system_clock::time_point captureTime; // when frameRaw was read
+    std::chrono::system_clock::time_point previousCaptureTime;
+    int fw;
+    int fh;
+    int frameCount;
+    double fps;
+    double frameInterval; // time step of the filters for a video file, 0 for a camera
+    
+    double scaleFactor;
+    
+    cv::Mat ur_mapx, ur_mapy; // undistort rectify matrices
+    
+    cv::Mat *estimatedStates;
+    std::vector<cv::Rect> regions; // inspect regions for each filter
+    
+    CirclesWorkspace workspace;
+    
+    MotionDetector *md;
+    
+    bool headless;
+    MyWindow *window; // NULL in the headless mode
+public:
+    VideoTracker(int ID) : id(ID) {
+        md = new MotionDetector(ID);
+    };
+    void init(ConfigParser config);
+    
+    /**
+     * Rereads the inspect region size and the filter parameters, so they can be
+     * changed between frames without restarting.
+     * @param config Configuration with the new values.
+     */
+    void configure(ConfigParser config);
+    
+    int next_frame();
+    ~VideoTracker() {
+        delete vid;
+        delete estimatedStates;
+        delete md;
+        for (int i = 0; i < filters.size(); i++) {
+            delete filters[i];
+        }
+    }
+    double getScaledWidth() {
+        return scaleFactor * fw;
+    }
+    double getScaledHeight() {
+        return scaleFactor * fh;
+    }
+    cv::Mat getFrame() {
+        return frame.clone();
+    }
+    std::chrono::system_clock::time_point getCaptureTime() {
+        return captureTime;
+    }
+    double getStateX(int balloon) {
+        return estimatedStates[balloon].at<float>(0);
+    }
+    double getStateY(int balloon) {
+        return estimatedStates[balloon].at<float>(1);
+    }
+    MyWindow* getWindow() {
+        return window;
+    }
+    int getFrameWidth() {
+        return fw;
+    }
+    int getFrameHeight() {
+        return fh;
+    }
+    double getFps() {
+        return fps;
+    }
+    
+    /**
+     * @return Image of the current frame with the inspect regions and the
+     * estimated positions, or NULL if the frame wasn't drawn, in the headless
+     * mode or when it is skipped by the display decimation.
+     */
+    cv::Mat* getVisualFrame() {
+        return drawing ? &frameVisual : NULL;
+    }
+    
+    double getConfidence(int balloon) {
+        return filters[balloon]->getConfidence();
+    }
+};
+
 #endif
\ No newline at end of file
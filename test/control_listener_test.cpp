@@ -0,0 +1,115 @@
+/*
+ * Checks that parameter updates sent to ControlListener with OSC address patterns
+ * set every matching key, and only those, under its own name. Prints the first
+ * wrong value and returns a non-zero exit code if there is one.
+ *
+ * Usage: control_listener_test [port]
+ *
+ * The listener is started on the port (47000 by default) of the loopback
+ * interface. Built from this file and src/control_listener.cpp,
+ * src/config_parser.cpp, src/osc and src/ip.
+ */
+
+#include "control_listener.h"
+
+#include "osc/OscOutboundPacketStream.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#define OUTPUT_BUFFER_SIZE 1024
+
+static const char *CONFIG_FILE = "control_listener_test.cfg";
+
+// sends a message with a single argument and waits until the listener has queued it
+static bool send(ControlListener &listener, ConfigParser &config, UdpTransmitSocket &socket,
+        const char *address, double value) {
+    char buffer[OUTPUT_BUFFER_SIZE];
+    osc::OutboundPacketStream p(buffer, OUTPUT_BUFFER_SIZE);
+    p << osc::BeginMessage(address) << value << osc::EndMessage;
+    socket.Send(p.Data(), p.Size());
+    
+    for (int i = 0; i < 100; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (listener.apply(&config)) {
+            return true;
+        }
+    }
+    std::cerr << "Nothing was set by " << address << "." << std::endl;
+    return false;
+}
+
+static bool expect(ConfigParser &config, const char *key, double value) {
+    double actual = config.getDouble(key, -1);
+    if (actual != value) {
+        std::cerr << key << " is " << actual << " instead of " << value << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool expect_missing(ConfigParser &config, const char *key) {
+    if (config.getString(key, NULL) != NULL) {
+        std::cerr << "The pattern was stored as the key " << key << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int port = argc > 1 ? atoi(argv[1]) : 47000;
+    
+    FILE *f = fopen(CONFIG_FILE, "w");
+    if (f == NULL) {
+        std::cerr << "Cannot write " << CONFIG_FILE << "." << std::endl;
+        return 1;
+    }
+    fprintf(f, "controlPort = %d\n", port);
+    fprintf(f, "nParticles = 100\nmeasurementSigma = 5\nhoughInverseRatio = 1\nhoughMinDistance = 10\n"
+            "houghThresholdCanny = 100\nhoughThresholdAccumulator = 20\nhoughMinRadius = 3\nhoughMaxRadius = 50\n");
+    fclose(f);
+    
+    ConfigParser config;
+    config.parse(CONFIG_FILE);
+    remove(CONFIG_FILE);
+    
+    ControlListener listener(config);
+    UdpTransmitSocket socket(IpEndpointName("127.0.0.1", port));
+    
+    bool ok = send(listener, config, socket, "/config/hough*", 4)
+            && expect(config, "houghInverseRatio", 4)
+            && expect(config, "houghMinDistance", 4)
+            && expect(config, "houghThresholdCanny", 4)
+            && expect(config, "houghThresholdAccumulator", 4)
+            && expect(config, "houghMaxRadius", 4)
+            && expect(config, "nParticles", 100)
+            && expect(config, "measurementSigma", 5)
+            && expect_missing(config, "hough*")
+            
+            && send(listener, config, socket, "/config/hough{MinDistance,ThresholdCanny}", 30)
+            && expect(config, "houghMinDistance", 30)
+            && expect(config, "houghThresholdCanny", 30)
+            && expect(config, "houghThresholdAccumulator", 4)
+            && expect_missing(config, "hough{MinDistance,ThresholdCanny}")
+            
+            && send(listener, config, socket, "/config/nParticle?", 200)
+            && expect(config, "nParticles", 200)
+            && expect_missing(config, "nParticle?")
+            
+            && send(listener, config, socket, "/config/measurementSigma", 2.5)
+            && expect(config, "measurementSigma", 2.5)
+            
+            // a maximum radius below houghMinRadius is rejected, the other matches are still set
+            && send(listener, config, socket, "/config/hough*", 2)
+            && expect(config, "houghMinDistance", 2)
+            && expect(config, "houghMaxRadius", 4);
+    
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "All updates were set." << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Checks that MaskFilter gives the same mask as thresholding, eroding and dilating
+ * with OpenCV, for the small elliptic elements and the anchors used by circles.cpp,
+ * on random blobs near and away from the borders. Prints the first mismatch and
+ * returns a non-zero exit code if there is one.
+ *
+ * Usage: mask_filter_test
+ *
+ * Built from this file and src/mask_filter.cpp.
+ */
+
+#include "mask_filter.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <iostream>
+
+#define BORDER 10
+
+// random mask with blobs of random values, some of them touching the image borders
+static cv::Mat random_mask(cv::RNG &rng, int width, int height) {
+    cv::Mat mask = cv::Mat::zeros(height, width, CV_8UC1);
+    int blobs = rng.uniform(1, 12);
+    for (int i = 0; i < blobs; i++) {
+        cv::Point centre(rng.uniform(-3, width + 3), rng.uniform(-3, height + 3));
+        cv::Size axes(rng.uniform(0, 8), rng.uniform(0, 8));
+        ellipse(mask, centre, axes, rng.uniform(0, 180), 0, 360, cv::Scalar::all(rng.uniform(1, 256)), -1);
+    }
+    // isolated noise pixels
+    for (int i = 0; i < width * height / 50; i++) {
+        mask.at<uchar>(rng.uniform(0, height), rng.uniform(0, width)) = (uchar) rng.uniform(1, 256);
+    }
+    return mask;
+}
+
+// the processing MaskFilter replaces, on a buffer with a zeroed border
+static cv::Mat reference(cv::Mat src, cv::Mat erodeElement, cv::Point erodeAnchor, cv::Mat dilateElement,
+        cv::Point dilateAnchor) {
+    cv::Mat dst = cv::Mat::zeros(src.rows + 2*BORDER, src.cols + 2*BORDER, CV_8UC1);
+    cv::Mat inner = dst(cv::Rect(BORDER, BORDER, src.cols, src.rows));
+    threshold(src, inner, 0, 255, cv::THRESH_BINARY);
+    erode(dst, dst, erodeElement, erodeAnchor);
+    dilate(dst, dst, dilateElement, dilateAnchor);
+    return dst;
+}
+
+static bool check(cv::Mat src, int erodeSize, int dilateSize, cv::Point erodeAnchor, cv::Point dilateAnchor) {
+    int ep = (erodeSize - 1) / 2 - 1;
+    int dp = (dilateSize - 1) / 2 - 1;
+    cv::Mat erodeElement = getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(erodeSize, erodeSize), cv::Point(ep, ep));
+    cv::Mat dilateElement = getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(dilateSize, dilateSize), cv::Point(dp, dp));
+    
+    MaskFilter filter;
+    filter.init(erodeElement, erodeAnchor, dilateElement, dilateAnchor);
+    cv::Mat result(src.rows + 2*BORDER, src.cols + 2*BORDER, CV_8UC1, cv::Scalar::all(7));
+    filter.apply(src, result, cv::Point(BORDER, BORDER));
+    
+    cv::Mat expected = reference(src, erodeElement, erodeAnchor, dilateElement, dilateAnchor);
+    for (int y = 0; y < expected.rows; y++) {
+        for (int x = 0; x < expected.cols; x++) {
+            if (result.at<uchar>(y, x) != expected.at<uchar>(y, x)) {
+                std::cerr << "Mismatch at (" << x << ", " << y << ") of a " << src.cols << "x" << src.rows
+                        << " mask, erosion " << erodeSize << " anchored at (" << erodeAnchor.x << ", "
+                        << erodeAnchor.y << "), dilation " << dilateSize << " anchored at (" << dilateAnchor.x
+                        << ", " << dilateAnchor.y << "): " << (int) result.at<uchar>(y, x) << " instead of "
+                        << (int) expected.at<uchar>(y, x) << "." << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    cv::RNG rng(1);
+    int checks = 0;
+    for (int erodeSize = 1; erodeSize <= 7; erodeSize++) {
+        for (int dilateSize = 1; dilateSize <= 7; dilateSize++) {
+            int ep = (erodeSize - 1) / 2 - 1;
+            int dp = (dilateSize - 1) / 2 - 1;
+            // the anchors used by circles.cpp and the ones passed to getStructuringElement
+            cv::Point anchors[2][2] = {
+                {cv::Point(-1, -1), cv::Point(-1, -1)},
+                {cv::Point(ep < 0 ? -1 : ep, ep < 0 ? -1 : ep), cv::Point(dp < 0 ? -1 : dp, dp < 0 ? -1 : dp)}
+            };
+            for (int a = 0; a < 2; a++) {
+                for (int i = 0; i < 10; i++) {
+                    cv::Mat src = random_mask(rng, rng.uniform(1, 150), rng.uniform(1, 80));
+                    if (!check(src, erodeSize, dilateSize, anchors[a][0], anchors[a][1])) {
+                        return 1;
+                    }
+                    checks++;
+                }
+            }
+        }
+    }
+    std::cout << checks << " masks match." << std::endl;
+    return 0;
+}